@@ -0,0 +1,815 @@
+#ifndef BASIC_THREADPOOL_H
+#define BASIC_THREADPOOL_H
+
+#include <vector>
+#include <stddef.h>
+#include <queue>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <future>
+#include <iostream>
+#include <type_traits>
+#include <algorithm>
+#include "threadpool.h"
+
+/*
+基于策略的线程池模版
+ThreadPool 在每次提交与取任务时都要判断 m_pool_mode、处理空闲回收逻辑，并经过 std::function 间接调用，
+即使 MODE_FIXED 根本用不到这些。BasicThreadPool 把这些选择放到编译期：
+    QueuePolicy  : MutexQueue 互斥队列 / RingQueue 无锁环形队列 / WorkStealingQueue 工作窃取队列
+    WaitPolicy   : BlockingWait 阻塞等待 / SpinWait 自旋等待 / HybridWait 先自旋后阻塞
+    SizingPolicy : FixedSizing 固定线程数 / ElasticSizing 线程数动态增长并空闲回收
+    TaskType     : 任务的表示，std::function<void()> 或只移动的 UniqueTask
+固定大小的线程池编译后，工作线程的循环只剩 取任务 -> 执行。
+
+example:
+FixedThreadPool pool;
+pool.start(4);
+auto res = pool.submitTask(sum1, 1, 2);
+
+BasicThreadPool<RingQueue, HybridWait<>, FixedSizing, UniqueTask> fast_pool;
+fast_pool.queue().set_capacity(4096);
+fast_pool.start(8);
+*/
+
+// ------------------------------------------- 任务表示 -------------------------------------------
+
+// 只移动的任务类型，packaged_task可以直接放入，不需要像std::function那样再包一层shared_ptr
+class UniqueTask
+{
+public:
+    UniqueTask() = default;
+    UniqueTask(UniqueTask&&) = default;
+    UniqueTask& operator=(UniqueTask&&) = default;
+
+    template<typename Func,
+        typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, UniqueTask>>>
+    UniqueTask(Func&& func)
+        : m_impl(std::make_unique<Impl<std::decay_t<Func>>>(std::forward<Func>(func)))
+    {}
+
+    void operator()()
+    {
+        m_impl->call();
+    }
+
+    explicit operator bool() const
+    {
+        return m_impl != nullptr;
+    }
+private:
+    class Base
+    {
+    public:
+        virtual ~Base() = default;
+        virtual void call() = 0;
+    };
+    template<typename Func>
+    class Impl : public Base
+    {
+    public:
+        Impl(Func&& func) : m_func(std::move(func))
+        {}
+        Impl(const Func& func) : m_func(func)
+        {}
+        void call() override
+        {
+            m_func();
+        }
+    private:
+        Func m_func;
+    };
+
+    std::unique_ptr<Base> m_impl;
+};
+
+// ------------------------------------------- 队列策略 -------------------------------------------
+// 队列策略需要提供：
+//     void set_capacity(size_t)               提交任务前设置容量
+//     void init(size_t worker_size)           启动时按工作线程槽位数初始化，start之前提交的任务需保留
+// 构造后即可接受提交，start之前提交的任务在线程启动后执行，与ThreadPool一致
+//     bool try_push(TaskType&, int worker)    满时返回false且不移走任务，worker为提交者所在的工作线程下标，外部线程为-1
+//     bool try_pop(TaskType&, size_t worker)  空时返回false
+// 队列内部通过原子变量记录任务数量，等待策略依赖它与工作线程的等待计数配对，避免丢失唤醒
+
+// 互斥锁 + std::queue，与ThreadPool的任务队列相同
+template<typename TaskType>
+class MutexQueue
+{
+public:
+    MutexQueue()
+        : m_capacity(TASK_MAX_THRESHHOLD)
+        , m_size(0)
+    {}
+
+    void set_capacity(size_t capacity)
+    {
+        m_capacity = capacity;
+    }
+
+    void init(size_t)
+    {}
+
+    bool try_push(TaskType& task, int)
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_que.size() >= m_capacity)
+        {
+            return false;
+        }
+        m_que.push(std::move(task));
+        m_size.fetch_add(1);
+        return true;
+    }
+
+    bool try_pop(TaskType& task, size_t)
+    {
+        if (m_size.load() == 0)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_que.empty())
+        {
+            return false;
+        }
+        task = std::move(m_que.front());
+        m_que.pop();
+        m_size.fetch_sub(1);
+        return true;
+    }
+private:
+    size_t m_capacity; // 队列上限
+    std::queue<TaskType> m_que;
+    std::mutex m_mtx;
+    std::atomic_size_t m_size; // 任务数量，空队列时不需要加锁
+};
+
+// 有界无锁多生产者多消费者环形队列（Vyukov），容量向上取整为2的幂
+template<typename TaskType>
+class RingQueue
+{
+public:
+    RingQueue()
+        : m_capacity(TASK_MAX_THRESHHOLD)
+        , m_mask(0)
+        , m_enqueue_pos(0)
+        , m_dequeue_pos(0)
+    {
+        allocate();
+    }
+
+    // 重新分配环形缓冲，队列中已有的任务会被丢弃，需在提交任务前调用
+    void set_capacity(size_t capacity)
+    {
+        m_capacity = capacity;
+        allocate();
+    }
+
+    void init(size_t)
+    {}
+
+    bool try_push(TaskType& task, int)
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->m_seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (dif < 0)
+            {
+                return false; // 队列已满
+            }
+            else
+            {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->m_task = std::move(task);
+        cell->m_seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(TaskType& task, size_t)
+    {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->m_seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0)
+            {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (dif < 0)
+            {
+                return false; // 队列为空
+            }
+            else
+            {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        task = std::move(cell->m_task);
+        cell->m_task = TaskType(); // 及时释放任务捕获的资源
+        cell->m_seq.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+private:
+    struct Cell
+    {
+        std::atomic_size_t m_seq;
+        TaskType m_task;
+    };
+
+    // 按m_capacity分配环形缓冲并重置读写位置
+    void allocate()
+    {
+        size_t size = 1;
+        while (size < m_capacity)
+        {
+            size <<= 1;
+        }
+        m_cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            m_cells[i].m_seq.store(i, std::memory_order_relaxed);
+        }
+        m_mask = size - 1;
+        m_enqueue_pos.store(0, std::memory_order_relaxed);
+        m_dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    size_t m_capacity;
+    size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic_size_t m_enqueue_pos; // 生产者与消费者的位置分开在不同缓存行
+    alignas(64) std::atomic_size_t m_dequeue_pos;
+};
+
+// 工作窃取队列：每个工作线程一个双端队列，工作线程提交的任务进入自己的队列并后进先出执行，
+// 外部提交轮流分配，自己的队列为空时从其他线程的队列头部窃取
+template<typename TaskType>
+class WorkStealingQueue
+{
+public:
+    WorkStealingQueue()
+        : m_capacity(TASK_MAX_THRESHHOLD)
+        , m_next_slot(0)
+        , m_size(0)
+    {
+        // start之前提交的任务先放在0号槽位，启动后由工作线程窃取执行
+        m_slots.emplace_back(std::make_unique<Slot>());
+    }
+
+    // 每个工作线程队列的上限
+    void set_capacity(size_t capacity)
+    {
+        m_capacity = capacity;
+    }
+
+    // 补足到每个工作线程一个槽位，保留已有槽位中的任务；start不能与外部的submitTask并发调用
+    void init(size_t worker_size)
+    {
+        for (size_t i = m_slots.size(); i < worker_size; ++i)
+        {
+            m_slots.emplace_back(std::make_unique<Slot>());
+        }
+    }
+
+    bool try_push(TaskType& task, int worker)
+    {
+        size_t index = worker >= 0
+            ? static_cast<size_t>(worker)
+            : m_next_slot.fetch_add(1, std::memory_order_relaxed) % m_slots.size();
+        Slot& slot = *m_slots[index];
+        std::lock_guard<std::mutex> lock(slot.m_mtx);
+        if (slot.m_que.size() >= m_capacity)
+        {
+            return false;
+        }
+        slot.m_que.push_back(std::move(task));
+        m_size.fetch_add(1);
+        return true;
+    }
+
+    bool try_pop(TaskType& task, size_t worker)
+    {
+        if (m_size.load() == 0)
+        {
+            return false;
+        }
+        {
+            // 自己的队列从尾部取，刚提交的任务数据还在缓存里
+            Slot& own = *m_slots[worker];
+            std::lock_guard<std::mutex> lock(own.m_mtx);
+            if (!own.m_que.empty())
+            {
+                task = std::move(own.m_que.back());
+                own.m_que.pop_back();
+                m_size.fetch_sub(1);
+                return true;
+            }
+        }
+        for (size_t i = 1; i < m_slots.size(); ++i)
+        {
+            Slot& victim = *m_slots[(worker + i) % m_slots.size()];
+            std::lock_guard<std::mutex> lock(victim.m_mtx);
+            if (!victim.m_que.empty())
+            {
+                task = std::move(victim.m_que.front());
+                victim.m_que.pop_front();
+                m_size.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+private:
+    struct Slot
+    {
+        std::mutex m_mtx;
+        std::deque<TaskType> m_que;
+    };
+
+    size_t m_capacity;
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::atomic_size_t m_next_slot; // 外部提交轮流分配的槽位
+    std::atomic_size_t m_size; // 所有槽位的任务总数
+};
+
+// ------------------------------------------- 等待策略 -------------------------------------------
+// 等待策略需要提供：
+//     void notify_one()                                  提交任务后调用
+//     void notify_all()                                  关闭线程池时调用
+//     void wait(Pred ready)                              等待直到ready()为true
+//     bool wait_for(Pred ready, std::chrono::nanoseconds) 超时返回false
+
+// 互斥锁 + 条件变量，只有存在等待者时提交方才去加锁唤醒
+class BlockingWait
+{
+public:
+    BlockingWait()
+        : m_waiters(0)
+    {}
+
+    void notify_one()
+    {
+        // 与wait中的栅栏配对：要么提交方看到等待者，要么等待者看到新任务
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+            }
+            m_cond.notify_one();
+        }
+    }
+
+    void notify_all()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+        }
+        m_cond.notify_all();
+    }
+
+    template<typename Pred>
+    void wait(Pred ready)
+    {
+        if (ready())
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_cond.wait(lock, ready);
+        m_waiters.fetch_sub(1);
+    }
+
+    template<typename Pred>
+    bool wait_for(Pred ready, std::chrono::nanoseconds timeout)
+    {
+        if (ready())
+        {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ok = m_cond.wait_for(lock, timeout, ready);
+        m_waiters.fetch_sub(1);
+        return ok;
+    }
+private:
+    std::mutex m_mtx;
+    std::condition_variable m_cond;
+    std::atomic_int m_waiters; // 正在等待的工作线程数量
+};
+
+// 自旋等待，不进入内核，适合独占CPU、对延迟敏感的线程池
+class SpinWait
+{
+public:
+    void notify_one()
+    {}
+
+    void notify_all()
+    {}
+
+    template<typename Pred>
+    void wait(Pred ready)
+    {
+        for (size_t spins = 0; !ready(); ++spins)
+        {
+            relax(spins);
+        }
+    }
+
+    template<typename Pred>
+    bool wait_for(Pred ready, std::chrono::nanoseconds timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (size_t spins = 0; !ready(); ++spins)
+        {
+            // 每自旋一段时间才读一次时钟
+            if ((spins & 1023) == 1023 && std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            relax(spins);
+        }
+        return true;
+    }
+
+    static void relax(size_t spins)
+    {
+        if (spins < 64)
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+};
+
+// 先自旋SpinCount次，仍没有任务再阻塞等待
+template<size_t SpinCount = 4096>
+class HybridWait
+{
+public:
+    void notify_one()
+    {
+        m_blocking.notify_one();
+    }
+
+    void notify_all()
+    {
+        m_blocking.notify_all();
+    }
+
+    template<typename Pred>
+    void wait(Pred ready)
+    {
+        for (size_t spins = 0; spins < SpinCount; ++spins)
+        {
+            if (ready())
+            {
+                return;
+            }
+            SpinWait::relax(spins);
+        }
+        m_blocking.wait(ready);
+    }
+
+    template<typename Pred>
+    bool wait_for(Pred ready, std::chrono::nanoseconds timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (size_t spins = 0; spins < SpinCount; ++spins)
+        {
+            if (ready())
+            {
+                return true;
+            }
+            SpinWait::relax(spins);
+        }
+        auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+        return m_blocking.wait_for(ready, std::max(left, std::chrono::nanoseconds::zero()));
+    }
+private:
+    BlockingWait m_blocking;
+};
+
+// ------------------------------------------- 线程数量策略 -------------------------------------------
+
+// 固定数量的线程，对应MODE_FIXED
+struct FixedSizing
+{
+    static constexpr bool is_elastic = false;
+};
+
+// 线程数量可动态增长，空闲超时的线程被回收，对应MODE_CACHED
+struct ElasticSizing
+{
+    static constexpr bool is_elastic = true;
+    size_t m_thread_size_thresh_hold = THREAD_MAX_THRESHHOLD; // 线程数量上限阈值
+    std::chrono::seconds m_max_idle_time = std::chrono::seconds(THREAD_MAX_IDLE_TIME); // 空闲回收时间
+};
+
+// ------------------------------------------- 线程池 -------------------------------------------
+
+template<template<typename> class QueuePolicy = MutexQueue,
+    typename WaitPolicy = BlockingWait,
+    typename SizingPolicy = FixedSizing,
+    typename TaskType = std::function<void()>>
+class BasicThreadPool
+{
+public:
+    BasicThreadPool()
+        : m_init_thread_size(0)
+        , m_worker_size(0)
+        , m_cur_thread_size(0)
+        , m_idle_thread_size(0)
+        , m_is_pool_running(false)
+        , m_is_stopping(false)
+    {}
+
+    // 通知所有线程退出，已经提交的任务会先执行完
+    ~BasicThreadPool()
+    {
+        m_is_stopping.store(true);
+        m_wait.notify_all();
+        // 只在锁内取出线程句柄，join时不持有m_spawn_mtx：
+        // 执行中的任务可能还在提交子任务，提交路径需要这把锁，持锁join会互相等待
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(m_spawn_mtx);
+            for (size_t i = 0; i < m_worker_size; ++i)
+            {
+                if (m_workers[i].m_thread.joinable())
+                {
+                    threads.push_back(std::move(m_workers[i].m_thread));
+                }
+            }
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // 队列策略，启动前可用于设置容量
+    QueuePolicy<TaskType>& queue()
+    {
+        return m_queue;
+    }
+
+    // 线程数量策略，启动前可用于设置线程上限与空闲回收时间
+    SizingPolicy& sizing()
+    {
+        return m_sizing;
+    }
+
+    //开启线程池
+    void start(size_t init_thread_size = std::thread::hardware_concurrency())
+    {
+        if (m_is_pool_running)
+        {
+            return;
+        }
+        m_is_pool_running = true;
+        m_init_thread_size = init_thread_size;
+        m_worker_size = init_thread_size;
+        if constexpr (SizingPolicy::is_elastic)
+        {
+            m_worker_size = std::max(init_thread_size, m_sizing.m_thread_size_thresh_hold);
+        }
+        m_workers = std::make_unique<Worker[]>(m_worker_size);
+        m_queue.init(m_worker_size);
+
+        std::lock_guard<std::mutex> lock(m_spawn_mtx);
+        for (size_t i = 0; i < m_init_thread_size; ++i)
+        {
+            start_worker(i);
+        }
+    }
+
+    // 给线程池提交任务，队列满时最长等待1s，超时判断提交失败
+    template<typename Func, typename... Args>
+    auto submitTask(Func&& func, Args&&... args) -> std::future<decltype(func(args...))>
+    {
+        using RType = decltype(func(args...));
+        std::packaged_task<RType()> task(
+            std::bind(std::forward<Func>(func), std::forward<Args>(args)...));
+        std::future<RType> result = task.get_future();
+        TaskType item = make_task(std::move(task));
+
+        int worker = t_current_pool == this ? static_cast<int>(t_worker_index) : -1;
+        if (!m_queue.try_push(item, worker))
+        {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            size_t spins = 0;
+            while (!m_queue.try_push(item, worker))
+            {
+                if (std::chrono::steady_clock::now() >= deadline)
+                {
+                    std::cerr << "task queue is full, submit task fail." << std::endl;
+                    std::packaged_task<RType()> empty([]()->RType { return RType(); });
+                    empty();
+                    return empty.get_future();
+                }
+                SpinWait::relax(spins++);
+            }
+        }
+        m_wait.notify_one();
+
+        if constexpr (SizingPolicy::is_elastic)
+        {
+            if (!m_is_stopping.load()
+                && m_idle_thread_size.load(std::memory_order_relaxed) == 0
+                && m_cur_thread_size.load(std::memory_order_relaxed) < m_sizing.m_thread_size_thresh_hold)
+            {
+                std::lock_guard<std::mutex> lock(m_spawn_mtx);
+                spawn_worker();
+            }
+        }
+        return result;
+    }
+
+    // 当前线程总数
+    size_t thread_size() const
+    {
+        return m_cur_thread_size.load();
+    }
+
+    BasicThreadPool(const BasicThreadPool&) = delete;
+    BasicThreadPool& operator=(const BasicThreadPool&) = delete;
+
+private:
+    struct Worker
+    {
+        std::thread m_thread;
+        std::atomic_bool m_is_alive{false}; // 槽位上的线程是否仍在运行
+    };
+
+    template<typename RType>
+    static TaskType make_task(std::packaged_task<RType()>&& task)
+    {
+        if constexpr (std::is_copy_constructible_v<TaskType>)
+        {
+            // std::function要求可拷贝，只能通过shared_ptr持有packaged_task
+            auto sp = std::make_shared<std::packaged_task<RType()>>(std::move(task));
+            return TaskType([sp]() { (*sp)(); });
+        }
+        else
+        {
+            return TaskType(std::move(task));
+        }
+    }
+
+    // 在槽位index上启动线程，需持有m_spawn_mtx
+    void start_worker(size_t index)
+    {
+        Worker& worker = m_workers[index];
+        if (worker.m_thread.joinable())
+        {
+            worker.m_thread.join(); // 回收已退出的旧线程
+        }
+        worker.m_is_alive.store(true);
+        m_cur_thread_size++;
+        if constexpr (SizingPolicy::is_elastic)
+        {
+            m_idle_thread_size++;
+        }
+        worker.m_thread = std::thread([this, index]() { thread_func(index); });
+    }
+
+    // 找一个空闲槽位创建新线程，需持有m_spawn_mtx
+    void spawn_worker()
+    {
+        if (m_is_stopping.load() || m_cur_thread_size.load() >= m_sizing.m_thread_size_thresh_hold)
+        {
+            return;
+        }
+        for (size_t i = 0; i < m_worker_size; ++i)
+        {
+            if (!m_workers[i].m_is_alive.load())
+            {
+                start_worker(i);
+                return;
+            }
+        }
+    }
+
+    // 空闲超时后尝试回收当前线程，线程数不会低于初始数量
+    bool try_retire(size_t index)
+    {
+        size_t cur = m_cur_thread_size.load();
+        while (cur > m_init_thread_size)
+        {
+            if (m_cur_thread_size.compare_exchange_weak(cur, cur - 1))
+            {
+                m_idle_thread_size--;
+                m_workers[index].m_is_alive.store(false);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 定义线程函数，固定大小时循环中只有取任务和执行任务
+    void thread_func(size_t index)
+    {
+        t_current_pool = this;
+        t_worker_index = index;
+        TaskType task;
+        bool got = false;
+        auto ready = [&]()->bool {
+            got = m_queue.try_pop(task, index);
+            return got || m_is_stopping.load(std::memory_order_acquire);
+        };
+        while (true)
+        {
+            if constexpr (SizingPolicy::is_elastic)
+            {
+                if (!m_wait.wait_for(ready, m_sizing.m_max_idle_time))
+                {
+                    if (try_retire(index))
+                    {
+                        return;
+                    }
+                    continue;
+                }
+            }
+            else
+            {
+                m_wait.wait(ready);
+            }
+            if (!got)
+            {
+                break; // 线程池关闭且队列已空
+            }
+            if constexpr (SizingPolicy::is_elastic)
+            {
+                m_idle_thread_size--;
+                task();
+                m_idle_thread_size++;
+            }
+            else
+            {
+                task();
+            }
+            task = TaskType();
+        }
+        m_workers[index].m_is_alive.store(false);
+    }
+
+private:
+    QueuePolicy<TaskType> m_queue; // 任务队列
+    WaitPolicy m_wait; // 工作线程的等待方式
+    SizingPolicy m_sizing; // 线程数量策略
+
+    std::unique_ptr<Worker[]> m_workers; // 工作线程槽位
+    size_t m_init_thread_size; // 初始线程数量
+    size_t m_worker_size; // 槽位数量，即线程数量上限
+    std::atomic_size_t m_cur_thread_size; // 当前线程总数
+    std::atomic_size_t m_idle_thread_size; // 空闲线程的数量，仅ElasticSizing使用
+    std::mutex m_spawn_mtx; // 保护线程的创建与回收
+
+    bool m_is_pool_running; // 是否已经start
+    std::atomic_bool m_is_stopping; // 线程池正在析构
+
+    inline static thread_local BasicThreadPool* t_current_pool = nullptr; // 当前线程所属的线程池
+    inline static thread_local size_t t_worker_index = 0; // 当前线程在线程池中的槽位
+};
+
+// 常用组合
+using FixedThreadPool = BasicThreadPool<MutexQueue, BlockingWait, FixedSizing>;
+using CachedThreadPool = BasicThreadPool<MutexQueue, BlockingWait, ElasticSizing>;
+
+#endif
@@ -0,0 +1,149 @@
+#define THREADPOOL_QUIET
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include "threadpool.h"
+#include "parallel_algorithm.h"
+#if __has_include(<execution>)
+#include <execution>
+#endif
+/*
+并行算法基准测试：与串行std算法以及std::execution::par对比
+编译：g++ -std=c++17 -O2 bench_parallel_algorithm.cpp -o bench_parallel_algorithm -pthread -ltbb
+libstdc++的std::execution::par在安装了TBB时需要链接-ltbb，没有TBB时退化为串行实现，此时去掉-ltbb
+*/
+
+#if defined(__cpp_lib_parallel_algorithm)
+#define HAS_STD_PAR 1
+#else
+#define HAS_STD_PAR 0
+#endif
+
+const size_t N = 1 << 24;
+const int REPEAT = 5;
+
+// 取多次运行的最小耗时，单位毫秒，prepare的时间不计入
+template<typename Prepare, typename Func>
+double measure(Prepare prepare, Func func)
+{
+    double best = 1e100;
+    for (int i = 0; i < REPEAT; ++i)
+    {
+        prepare();
+        auto begin = std::chrono::steady_clock::now();
+        func();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+    return best;
+}
+
+// par小于0表示没有std::execution::par，不参与比较
+void report(const char* name, double serial, double par, double pool)
+{
+    std::cout << name << "\tserial " << serial << " ms";
+    if (par < 0)
+    {
+        std::cout << "\tstd::par n/a";
+    }
+    else
+    {
+        std::cout << "\tstd::par " << par << " ms";
+    }
+    std::cout << "\tThreadPool " << pool << " ms"
+        << "\tspeedup " << serial / pool << "x" << std::endl;
+}
+
+int main()
+{
+    ThreadPool pool;
+    pool.start(std::thread::hardware_concurrency());
+
+    std::mt19937_64 rng(42);
+    std::vector<long long> origin(N);
+    for (auto& v : origin)
+    {
+        v = rng() % 1000000000;
+    }
+    std::vector<long long> data;
+    std::vector<long long> out(N);
+    auto reset = [&]() { data = origin; };
+    auto none = []() {};
+    const long long target = -1; // 只出现在3/4处，find_if需要扫描大部分区间
+    data = origin;
+    data[N * 3 / 4] = target;
+    auto is_target = [&](long long x) { return x == target; };
+    auto is_even = [](long long x) { return x % 2 == 0; };
+    auto square = [](long long x) { return x * x % 1000003; };
+
+    double serial = measure(reset, [&]() { std::sort(data.begin(), data.end()); });
+    double par = -1;
+#if HAS_STD_PAR
+    par = measure(reset, [&]() { std::sort(std::execution::par, data.begin(), data.end()); });
+#endif
+    double mine = measure(reset, [&]() { parallel_sort(pool, data.begin(), data.end()); });
+    if (!std::is_sorted(data.begin(), data.end()))
+    {
+        std::cerr << "parallel_sort result is wrong" << std::endl;
+        return 1;
+    }
+    report("sort", serial, par, mine);
+
+    reset();
+    serial = measure(none, [&]() { std::inclusive_scan(data.begin(), data.end(), out.begin()); });
+#if HAS_STD_PAR
+    par = measure(none, [&]() { std::inclusive_scan(std::execution::par, data.begin(), data.end(), out.begin()); });
+#endif
+    std::vector<long long> expected(N);
+    std::inclusive_scan(data.begin(), data.end(), expected.begin());
+    mine = measure(none, [&]() { parallel_inclusive_scan(pool, data.begin(), data.end(), out.begin()); });
+    if (out != expected)
+    {
+        std::cerr << "parallel_inclusive_scan result is wrong" << std::endl;
+        return 1;
+    }
+    report("scan", serial, par, mine);
+
+    serial = measure(none, [&]() { std::transform(data.begin(), data.end(), out.begin(), square); });
+#if HAS_STD_PAR
+    par = measure(none, [&]() { std::transform(std::execution::par, data.begin(), data.end(), out.begin(), square); });
+#endif
+    std::transform(data.begin(), data.end(), expected.begin(), square);
+    mine = measure(none, [&]() { parallel_transform(pool, data.begin(), data.end(), out.begin(), square); });
+    if (out != expected)
+    {
+        std::cerr << "parallel_transform result is wrong" << std::endl;
+        return 1;
+    }
+    report("transform", serial, par, mine);
+
+    volatile size_t found = 0; // volatile防止串行版本的结果未被使用而被优化掉
+    data[N * 3 / 4] = target;
+    serial = measure(none, [&]() { found = std::find_if(data.begin(), data.end(), is_target) - data.begin(); });
+#if HAS_STD_PAR
+    par = measure(none, [&]() { found = std::find_if(std::execution::par, data.begin(), data.end(), is_target) - data.begin(); });
+#endif
+    mine = measure(none, [&]() { found = parallel_find_if(pool, data.begin(), data.end(), is_target) - data.begin(); });
+    if (found != N * 3 / 4)
+    {
+        std::cerr << "parallel_find_if result is wrong" << std::endl;
+        return 1;
+    }
+    report("find_if", serial, par, mine);
+
+    volatile size_t cnt = 0;
+    serial = measure(none, [&]() { cnt = std::count_if(data.begin(), data.end(), is_even); });
+#if HAS_STD_PAR
+    par = measure(none, [&]() { cnt = std::count_if(std::execution::par, data.begin(), data.end(), is_even); });
+#endif
+    mine = measure(none, [&]() { cnt = parallel_count_if(pool, data.begin(), data.end(), is_even); });
+    report("count_if", serial, par, mine);
+    if (cnt != static_cast<size_t>(std::count_if(data.begin(), data.end(), is_even)))
+    {
+        std::cerr << "parallel_count_if result is wrong" << std::endl;
+        return 1;
+    }
+}
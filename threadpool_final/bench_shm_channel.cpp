@@ -0,0 +1,127 @@
+#define THREADPOOL_QUIET
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "threadpool.h"
+#include "shm_channel.h"
+/*
+共享内存任务通道的双进程基准测试
+fork出的子进程作为生产者，父进程作为消费者，负载中带有发送时的CLOCK_MONOTONIC时间戳：
+1. 吞吐：生产者连续发送，消费者直接从通道取出，统计每秒消息数
+2. 延迟：生产者按固定间隔发送，消费者通过ShmTaskConsumer交给线程池执行，统计发送到处理函数开始执行的延迟分位数
+编译：g++ -std=c++17 -O2 bench_shm_channel.cpp -o bench_shm_channel -pthread
+*/
+
+const size_t CHANNEL_CAPACITY = 4096;
+const size_t THROUGHPUT_COUNT = 2000000;
+const size_t LATENCY_COUNT = 20000;
+const int LATENCY_INTERVAL_US = 20; // 延迟测试中的发送间隔
+const uint32_t THROUGHPUT_HANDLER = 1;
+const uint32_t LATENCY_HANDLER = 2;
+
+struct BenchPayload
+{
+    uint64_t m_index;
+    uint64_t m_send_ns;
+};
+
+uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p)
+{
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+void run_producer(ShmTaskChannel& channel)
+{
+    BenchPayload payload;
+    for (size_t i = 0; i < THROUGHPUT_COUNT; ++i)
+    {
+        payload.m_index = i;
+        payload.m_send_ns = now_ns();
+        channel.push(THROUGHPUT_HANDLER, &payload, sizeof(payload));
+    }
+    for (size_t i = 0; i < LATENCY_COUNT; ++i)
+    {
+        payload.m_index = i;
+        payload.m_send_ns = now_ns();
+        channel.push(LATENCY_HANDLER, &payload, sizeof(payload));
+        uint64_t next = payload.m_send_ns + LATENCY_INTERVAL_US * 1000;
+        while (now_ns() < next)
+        {}
+    }
+}
+
+int main()
+{
+    auto channel = ShmTaskChannel::create_memfd(CHANNEL_CAPACITY);
+    if (!channel)
+    {
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "fork fail" << std::endl;
+        return 1;
+    }
+    if (pid == 0)
+    {
+        run_producer(*channel);
+        _exit(0);
+    }
+
+    // 吞吐
+    ShmMessage message;
+    auto begin = std::chrono::steady_clock::now();
+    size_t received = 0;
+    while (received < THROUGHPUT_COUNT)
+    {
+        if (channel->try_pop(message))
+        {
+            received++;
+        }
+        else
+        {
+            channel->wait(std::chrono::milliseconds(100));
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "throughput: " << THROUGHPUT_COUNT / elapsed << " msgs/s" << std::endl;
+
+    // 延迟
+    std::vector<uint64_t> latencies(LATENCY_COUNT);
+    std::atomic_size_t handled(0);
+    {
+        ThreadPool pool;
+        pool.start(std::thread::hardware_concurrency());
+        ShmTaskConsumer<ThreadPool> consumer(*channel, pool);
+        consumer.register_handler(LATENCY_HANDLER, [&](const char* data, size_t) {
+            const BenchPayload* payload = reinterpret_cast<const BenchPayload*>(data);
+            latencies[payload->m_index] = now_ns() - payload->m_send_ns;
+            handled++;
+        });
+        consumer.start();
+        while (handled < LATENCY_COUNT)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        consumer.stop();
+    }
+    waitpid(pid, nullptr, 0);
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "latency(us)\tp50 " << percentile(latencies, 0.5) / 1000.0
+        << "\tp90 " << percentile(latencies, 0.9) / 1000.0
+        << "\tp99 " << percentile(latencies, 0.99) / 1000.0
+        << "\tmax " << percentile(latencies, 1.0) / 1000.0 << std::endl;
+}
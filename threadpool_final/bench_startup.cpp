@@ -0,0 +1,96 @@
+#define THREADPOOL_QUIET
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <unistd.h>
+#include "threadpool.h"
+/*
+线程池启动基准测试：
+1. 从构造线程池到第一个任务执行的耗时
+2. 每个空闲线程池占用的常驻内存（RSS）与虚拟内存
+编译：g++ -std=c++17 -O2 bench_startup.cpp -o bench_startup -pthread
+*/
+
+const int POOL_COUNT = 32; // 测量内存时同时存在的线程池数量
+const int REPEAT = 20;
+
+struct Config
+{
+    const char* name;
+    size_t stack_size;
+    bool is_lazy_start;
+    bool is_warm_up;
+};
+
+void configure(ThreadPool& pool, const Config& config)
+{
+    pool.set_stack_size(config.stack_size);
+    pool.set_lazy_start(config.is_lazy_start);
+    pool.set_warm_up(config.is_warm_up);
+    pool.set_thread_name("bench-");
+}
+
+// 读取/proc/self/statm，返回<虚拟内存, 常驻内存>，单位：KB
+std::pair<long, long> memory_usage()
+{
+    std::ifstream statm("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+    statm >> size >> resident;
+    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    return {size * page_kb, resident * page_kb};
+}
+
+int main()
+{
+    size_t threads = std::thread::hardware_concurrency();
+    std::vector<Config> configs = {
+        {"default", 0, false, false},
+        {"stack 256KB", 256 * 1024, false, false},
+        {"lazy", 0, true, false},
+        {"lazy + stack 256KB", 256 * 1024, true, false},
+        {"warm up", 0, false, true},
+    };
+
+    std::vector<std::string> results;
+    for (const Config& config : configs)
+    {
+        // 构造到第一个任务执行的耗时，取平均值
+        double total_us = 0;
+        for (int i = 0; i < REPEAT; ++i)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            ThreadPool pool;
+            configure(pool, config);
+            pool.start(threads);
+            auto first = pool.submitTask([]() { return std::chrono::steady_clock::now(); }).get();
+            total_us += std::chrono::duration<double, std::micro>(first - begin).count();
+        }
+
+        // 同时保留POOL_COUNT个空闲线程池，计算每个线程池的内存占用
+        auto before = memory_usage();
+        {
+            std::vector<std::unique_ptr<ThreadPool>> pools;
+            for (int i = 0; i < POOL_COUNT; ++i)
+            {
+                pools.emplace_back(std::make_unique<ThreadPool>());
+                configure(*pools.back(), config);
+                pools.back()->start(threads);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            auto after = memory_usage();
+            results.push_back(std::string(config.name)
+                + "\tfirst task " + std::to_string(total_us / REPEAT) + " us"
+                + "\tRSS/pool " + std::to_string((after.second - before.second) / POOL_COUNT) + " KB"
+                + "\tVM/pool " + std::to_string((after.first - before.first) / POOL_COUNT) + " KB");
+        }
+    }
+
+    std::cout << "threads per pool: " << threads << std::endl;
+    for (const std::string& line : results)
+    {
+        std::cout << line << std::endl;
+    }
+}
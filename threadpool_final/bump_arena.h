@@ -0,0 +1,160 @@
+#ifndef BUMP_ARENA_H
+#define BUMP_ARENA_H
+
+#include <stddef.h>
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+const size_t ARENA_BLOCK_SIZE = 64 * 1024; // 每块的默认大小
+
+/*
+顺序分配的内存池，分配只是移动偏移量，不支持单独释放，reset后全部内存重新可用。
+ThreadPool的每个工作线程持有一个BumpArena，每个任务执行完后reset，
+任务内的临时缓冲可以从这里分配，省去每个任务的new/delete。
+内存块在第一次分配时才申请，reset后保留以便复用。
+通过create构造的对象不会调用析构函数，只适合放置平凡析构的数据，容器可以使用ArenaAllocator。
+*/
+class BumpArena
+{
+public:
+    explicit BumpArena(size_t block_size = ARENA_BLOCK_SIZE)
+        : m_block_size(block_size)
+        , m_cur_block(0)
+        , m_offset(0)
+        , m_is_used(false)
+    {}
+    ~BumpArena() = default;
+    BumpArena(const BumpArena&) = delete;
+    BumpArena& operator=(const BumpArena&) = delete;
+
+    // 分配size字节，按align对齐
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        m_is_used = true;
+        while (m_cur_block < m_blocks.size())
+        {
+            Block& block = m_blocks[m_cur_block];
+            size_t start = (reinterpret_cast<size_t>(block.m_data.get()) + m_offset + align - 1) & ~(align - 1);
+            size_t offset = start - reinterpret_cast<size_t>(block.m_data.get());
+            if (offset + size <= block.m_size)
+            {
+                m_offset = offset + size;
+                return block.m_data.get() + offset;
+            }
+            // 当前块放不下，使用下一块
+            m_cur_block++;
+            m_offset = 0;
+        }
+        size_t block_size = std::max(m_block_size, size + align);
+        m_blocks.push_back(Block{std::make_unique<char[]>(block_size), block_size});
+        m_cur_block = m_blocks.size() - 1;
+        m_offset = 0;
+        return allocate(size, align);
+    }
+
+    // 在arena上构造对象，对象的析构函数不会被调用
+    template<typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // 所有分配失效，内存块保留复用
+    void reset()
+    {
+        if (!m_is_used)
+        {
+            return;
+        }
+        m_cur_block = 0;
+        m_offset = 0;
+        m_is_used = false;
+    }
+
+    // 预先申请第一块内存并逐页写入，避免第一个任务触发缺页
+    void warm_up()
+    {
+        if (m_blocks.empty())
+        {
+            m_blocks.push_back(Block{std::make_unique<char[]>(m_block_size), m_block_size});
+        }
+        char* data = m_blocks[0].m_data.get();
+        for (size_t i = 0; i < m_blocks[0].m_size; i += 4096)
+        {
+            data[i] = 0;
+        }
+    }
+
+    // 已申请的内存总量
+    size_t capacity() const
+    {
+        size_t total = 0;
+        for (const Block& block : m_blocks)
+        {
+            total += block.m_size;
+        }
+        return total;
+    }
+private:
+    struct Block
+    {
+        std::unique_ptr<char[]> m_data;
+        size_t m_size;
+    };
+
+    size_t m_block_size; // 每块的默认大小
+    std::vector<Block> m_blocks;
+    size_t m_cur_block; // 当前分配所在的块
+    size_t m_offset; // 当前块已使用的字节数
+    bool m_is_used; // 上次reset后是否分配过
+};
+
+// 从BumpArena分配内存的分配器，deallocate不做任何事，内存在arena reset时统一回收
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(BumpArena* arena)
+        : m_arena(arena)
+    {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : m_arena(other.arena())
+    {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t)
+    {}
+
+    BumpArena* arena() const
+    {
+        return m_arena;
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return m_arena == other.arena();
+    }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return m_arena != other.arena();
+    }
+private:
+    BumpArena* m_arena;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+任务负载录制文件格式
+文件头为8字节的CAPTURE_MAGIC，之后是连续的CaptureRecord，每条24字节，按本机字节序存放。
+记录按任务完成的顺序写入，回放时需要按m_submit_ns排序。
+*/
+
+const char CAPTURE_MAGIC[8] = {'T', 'P', 'C', 'A', 'P', '0', '0', '1'};
+
+// 一个任务的录制信息
+struct CaptureRecord
+{
+    uint64_t m_submit_ns; // 提交时间，相对录制开始的纳秒数
+    uint64_t m_run_ns; // 执行耗时，单位：纳秒
+    uint32_t m_tag; // 任务类别标签
+    int32_t m_tenant_id; // 提交到的租户
+};
+
+static_assert(sizeof(CaptureRecord) == 24, "CaptureRecord must be packed to 24 bytes");
+
+// 录制文件的写入，内部缓冲后批量写入文件，调用方负责加锁
+class CaptureWriter
+{
+public:
+    CaptureWriter()
+        : m_file(nullptr)
+    {}
+    ~CaptureWriter()
+    {
+        close();
+    }
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open(const std::string& path)
+    {
+        close();
+        m_file = fopen(path.c_str(), "wb");
+        if (m_file == nullptr)
+        {
+            return false;
+        }
+        fwrite(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC), 1, m_file);
+        return true;
+    }
+
+    void append(const CaptureRecord& record)
+    {
+        m_buffer.push_back(record);
+        if (m_buffer.size() >= BUFFER_SIZE)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (m_file != nullptr && !m_buffer.empty())
+        {
+            fwrite(m_buffer.data(), sizeof(CaptureRecord), m_buffer.size(), m_file);
+            fflush(m_file);
+        }
+        m_buffer.clear();
+    }
+
+    void close()
+    {
+        if (m_file == nullptr)
+        {
+            return;
+        }
+        flush();
+        fclose(m_file);
+        m_file = nullptr;
+    }
+private:
+    static const size_t BUFFER_SIZE = 4096; // 缓冲的记录条数
+
+    FILE* m_file;
+    std::vector<CaptureRecord> m_buffer;
+};
+
+// 读取录制文件，格式不正确时返回false
+inline bool read_capture(const std::string& path, std::vector<CaptureRecord>& records)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    char magic[sizeof(CAPTURE_MAGIC)];
+    if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+    CaptureRecord record;
+    while (fread(&record, sizeof(record), 1, file) == 1)
+    {
+        records.push_back(record);
+    }
+    fclose(file);
+    return true;
+}
+
+#endif
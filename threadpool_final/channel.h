@@ -0,0 +1,696 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "when_all.h"
+
+/*
+有界多生产者多消费者通道 Channel<T>
+任务之间以流的方式传递数据，容量为0时发送方与接收方直接交接。
+send/recv会阻塞调用线程，只适合在线程池外部使用；线程池中的任务应使用send_async/recv_async：
+不能立即完成时只登记一个等待者就返回，工作线程去执行其他任务，
+等到对端操作（或close）完成这次收发时，再把回调作为新任务提交到线程池，相当于把任务挂起后恢复。
+Select在多个通道上等待，第一个能完成的分支生效，其余分支登记的等待者通过共享的认领标志作废。
+send_n/recv_n在一次加锁中收发多个数据，减少逐个收发的同步开销，同样会阻塞调用线程；
+线程池中的任务使用send_n_async/recv_n_async，一次加锁收发能完成的部分，剩余部分登记等待者后在线程池中继续。
+close之后发送失败，接收方仍可以取完通道中剩余的数据，之后接收得到std::nullopt。
+异步操作完成之前通道必须保持有效。
+
+example:
+Channel<int> ch(64);
+// 生产者在线程池外部，可以使用阻塞的send
+std::thread producer([&]() { for (int i = 0; i < 100; ++i) ch.send(i); ch.close(); });
+std::function<void(std::optional<int>)> consume = [&](std::optional<int> v) {
+    if (v) { process(*v); ch.recv_async(pool, consume); }
+};
+ch.recv_async(pool, consume);
+*/
+
+// 等待者的认领标志，Select的多个等待者共用一个，只有第一个认领成功的收发生效
+struct ChannelClaim
+{
+    std::atomic_bool m_is_claimed{false};
+
+    bool claim()
+    {
+        return !m_is_claimed.exchange(true);
+    }
+
+    bool is_claimed() const
+    {
+        return m_is_claimed.load();
+    }
+};
+
+// 释放通道锁之后再执行的回调，避免在锁内唤醒等待方或提交任务
+using ChannelPending = std::vector<std::function<void()>>;
+
+inline void run_pending(ChannelPending& pending)
+{
+    for (auto& func : pending)
+    {
+        func();
+    }
+}
+
+class Select;
+
+template<typename T>
+class Channel
+{
+public:
+    using RecvCallback = std::function<void(std::optional<T>)>; // 接收完成，通道关闭且为空时参数为std::nullopt
+    using SendCallback = std::function<void(bool)>; // 发送完成，通道关闭时参数为false
+
+    explicit Channel(size_t capacity)
+        : m_capacity(capacity)
+        , m_is_closed(false)
+    {}
+    ~Channel() = default;
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // 非阻塞发送，通道已满或已关闭时返回false，此时value不会被移走
+    template<typename U>
+    bool try_send(U&& value)
+    {
+        ChannelPending pending;
+        bool is_sent;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            is_sent = send_locked(std::forward<U>(value), pending) == Status::OK;
+        }
+        run_pending(pending);
+        return is_sent;
+    }
+
+    // 阻塞发送，通道关闭时返回false
+    template<typename U>
+    bool send(U&& value)
+    {
+        ChannelPending pending;
+        auto promise = std::make_shared<std::promise<bool>>();
+        std::future<bool> result = promise->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            Status status = send_locked(std::forward<U>(value), pending);
+            if (status != Status::WOULD_BLOCK)
+            {
+                promise->set_value(status == Status::OK);
+            }
+            else
+            {
+                park_send(std::make_shared<ChannelClaim>(), T(std::forward<U>(value)),
+                    [promise](bool is_sent) { promise->set_value(is_sent); });
+            }
+        }
+        run_pending(pending);
+        return result.get();
+    }
+
+    // 异步发送，完成后把func(bool)作为任务提交到线程池
+    template<typename Pool, typename Func>
+    void send_async(Pool& pool, T value, Func func)
+    {
+        ChannelPending pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto claim = std::make_shared<ChannelClaim>();
+            SendCallback deliver = [&pool, func](bool is_sent) {
+                when_detail::post(pool, [func, is_sent]() mutable { func(is_sent); });
+            };
+            if (!arm_send(claim, value, deliver, pending))
+            {
+                park_send(claim, std::move(value), std::move(deliver));
+            }
+        }
+        run_pending(pending);
+    }
+
+    // 非阻塞接收，通道为空时返回std::nullopt
+    std::optional<T> try_recv()
+    {
+        ChannelPending pending;
+        std::optional<T> value;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            recv_locked(value, pending);
+        }
+        run_pending(pending);
+        return value;
+    }
+
+    // 阻塞接收，通道关闭且为空时返回std::nullopt
+    std::optional<T> recv()
+    {
+        ChannelPending pending;
+        auto promise = std::make_shared<std::promise<std::optional<T>>>();
+        std::future<std::optional<T>> result = promise->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            std::optional<T> value;
+            if (recv_locked(value, pending) != Status::WOULD_BLOCK)
+            {
+                promise->set_value(std::move(value));
+            }
+            else
+            {
+                park_recv(std::make_shared<ChannelClaim>(),
+                    [promise](std::optional<T> value) { promise->set_value(std::move(value)); });
+            }
+        }
+        run_pending(pending);
+        return result.get();
+    }
+
+    // 异步接收，完成后把func(std::optional<T>)作为任务提交到线程池
+    template<typename Pool, typename Func>
+    void recv_async(Pool& pool, Func func)
+    {
+        ChannelPending pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto claim = std::make_shared<ChannelClaim>();
+            RecvCallback deliver = [&pool, func](std::optional<T> value) {
+                auto box = std::make_shared<std::optional<T>>(std::move(value));
+                when_detail::post(pool, [func, box]() mutable { func(std::move(*box)); });
+            };
+            if (!arm_recv(claim, deliver, pending))
+            {
+                park_recv(claim, std::move(deliver));
+            }
+        }
+        run_pending(pending);
+    }
+
+    // 批量发送[first, last)，放不下时阻塞等待空位，返回发送成功的个数，通道关闭时提前返回
+    // 会阻塞调用线程，线程池任务中应使用send_n_async
+    template<typename InputIt>
+    size_t send_n(InputIt first, InputIt last)
+    {
+        size_t count = 0;
+        while (first != last)
+        {
+            ChannelPending pending;
+            bool is_closed;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                while (first != last && send_locked(*first, pending) == Status::OK)
+                {
+                    ++first;
+                    ++count;
+                }
+                is_closed = m_is_closed;
+            }
+            run_pending(pending);
+            if (first == last || is_closed)
+            {
+                break;
+            }
+            // 通道已满，阻塞发送一个后继续批量发送
+            if (!send(*first))
+            {
+                break;
+            }
+            ++first;
+            ++count;
+        }
+        return count;
+    }
+
+    // 批量接收最多max_count个数据写入out，通道为空时阻塞直到至少收到一个，
+    // 返回接收的个数，通道关闭且为空时返回0。会阻塞调用线程，线程池任务中应使用recv_n_async
+    template<typename OutputIt>
+    size_t recv_n(OutputIt out, size_t max_count)
+    {
+        if (max_count == 0)
+        {
+            return 0;
+        }
+        size_t count = recv_some(out, max_count);
+        if (count > 0)
+        {
+            return count;
+        }
+        std::optional<T> value = recv();
+        if (!value)
+        {
+            return 0;
+        }
+        *out = std::move(*value);
+        ++out;
+        return 1 + recv_some(out, max_count - 1);
+    }
+
+    // 异步批量发送values，一次加锁放入能放下的部分，通道已满时为下一个数据登记等待者，
+    // 发送出去后在线程池中继续发送剩余的数据；全部发送完或通道关闭后把func(发送成功的个数)提交到线程池
+    template<typename Pool, typename Func>
+    void send_n_async(Pool& pool, std::vector<T> values, Func func)
+    {
+        send_batch(pool, std::make_shared<SendBatch>(SendBatch{std::move(values), 0}), std::move(func));
+    }
+
+    // 异步批量接收最多max_count个数据，一次加锁取出已有的数据；通道为空时登记等待者，
+    // 收到第一个数据后再不等待地取出其余的数据。完成后把func(std::vector<T>)提交到线程池，
+    // 通道关闭且为空时vector为空
+    template<typename Pool, typename Func>
+    void recv_n_async(Pool& pool, size_t max_count, Func func)
+    {
+        auto values = std::make_shared<std::vector<T>>();
+        ChannelPending pending;
+        bool is_ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            auto out = std::back_inserter(*values);
+            recv_some_locked(out, max_count, pending);
+            is_ready = !values->empty() || max_count == 0 || m_is_closed;
+            if (!is_ready)
+            {
+                park_recv(std::make_shared<ChannelClaim>(), [this, &pool, max_count, func](std::optional<T> value) {
+                    auto box = std::make_shared<std::optional<T>>(std::move(value));
+                    when_detail::post(pool, [this, max_count, func, box]() mutable {
+                        std::vector<T> values;
+                        if (*box)
+                        {
+                            values.push_back(std::move(**box));
+                            auto out = std::back_inserter(values);
+                            recv_some(out, max_count - 1);
+                        }
+                        func(std::move(values));
+                    });
+                });
+            }
+        }
+        run_pending(pending);
+        if (is_ready)
+        {
+            when_detail::post(pool, [func, values]() mutable { func(std::move(*values)); });
+        }
+    }
+
+    // 关闭通道，等待中的发送方得到false，等待中的接收方得到std::nullopt
+    void close()
+    {
+        ChannelPending pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            if (m_is_closed)
+            {
+                return;
+            }
+            m_is_closed = true;
+            for (RecvWaiter& waiter : m_receivers)
+            {
+                if (waiter.m_claim->claim())
+                {
+                    pending.push_back([deliver = std::move(waiter.m_deliver)]() { deliver(std::nullopt); });
+                }
+            }
+            for (SendWaiter& waiter : m_senders)
+            {
+                if (waiter.m_claim->claim())
+                {
+                    pending.push_back([deliver = std::move(waiter.m_deliver)]() { deliver(false); });
+                }
+            }
+            m_receivers.clear();
+            m_senders.clear();
+        }
+        run_pending(pending);
+    }
+
+    bool is_closed() const
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_is_closed;
+    }
+
+    // 通道中缓冲的数据个数
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_buffer.size();
+    }
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+private:
+    friend class Select;
+
+    enum class Status
+    {
+        OK, // 完成
+        CLOSED, // 通道已关闭
+        WOULD_BLOCK, // 需要等待
+    };
+
+    struct RecvWaiter
+    {
+        std::shared_ptr<ChannelClaim> m_claim;
+        RecvCallback m_deliver;
+    };
+
+    struct SendWaiter
+    {
+        std::shared_ptr<ChannelClaim> m_claim;
+        T m_value;
+        SendCallback m_deliver;
+    };
+
+    // send_n_async中尚未发送完的数据
+    struct SendBatch
+    {
+        std::vector<T> m_values;
+        size_t m_next; // 下一个要发送的下标，之前的都已发送或已交给等待者
+    };
+
+    // 以下函数需要持有m_mtx
+    // 发送，优先直接交给等待中的接收方，其次放入缓冲，只有完成时才会移走value
+    template<typename U>
+    Status send_locked(U&& value, ChannelPending& pending)
+    {
+        if (m_is_closed)
+        {
+            return Status::CLOSED;
+        }
+        while (!m_receivers.empty())
+        {
+            RecvWaiter waiter = std::move(m_receivers.front());
+            m_receivers.pop_front();
+            // 认领失败说明该等待者所在的Select已经在别的通道上完成
+            if (waiter.m_claim->claim())
+            {
+                auto box = std::make_shared<std::optional<T>>(std::forward<U>(value));
+                pending.push_back([deliver = std::move(waiter.m_deliver), box]() { deliver(std::move(*box)); });
+                return Status::OK;
+            }
+        }
+        if (m_buffer.size() < m_capacity)
+        {
+            m_buffer.emplace_back(std::forward<U>(value));
+            return Status::OK;
+        }
+        return Status::WOULD_BLOCK;
+    }
+
+    // 接收，取出缓冲的数据后用等待中的发送方补上空位；容量为0时直接从发送方取
+    Status recv_locked(std::optional<T>& value, ChannelPending& pending)
+    {
+        if (!m_buffer.empty())
+        {
+            value.emplace(std::move(m_buffer.front()));
+            m_buffer.pop_front();
+            while (m_buffer.size() < m_capacity && !m_senders.empty())
+            {
+                SendWaiter waiter = std::move(m_senders.front());
+                m_senders.pop_front();
+                if (waiter.m_claim->claim())
+                {
+                    m_buffer.emplace_back(std::move(waiter.m_value));
+                    pending.push_back([deliver = std::move(waiter.m_deliver)]() { deliver(true); });
+                }
+            }
+            return Status::OK;
+        }
+        while (!m_senders.empty())
+        {
+            SendWaiter waiter = std::move(m_senders.front());
+            m_senders.pop_front();
+            if (waiter.m_claim->claim())
+            {
+                value.emplace(std::move(waiter.m_value));
+                pending.push_back([deliver = std::move(waiter.m_deliver)]() { deliver(true); });
+                return Status::OK;
+            }
+        }
+        return m_is_closed ? Status::CLOSED : Status::WOULD_BLOCK;
+    }
+
+    // 尝试立即完成一次发送，完成时认领claim并把deliver放入pending，返回是否完成
+    // claim在登记等待者之前不可能被其他线程认领，所以这里的认领一定成功
+    bool arm_send(const std::shared_ptr<ChannelClaim>& claim, T& value, const SendCallback& deliver, ChannelPending& pending)
+    {
+        Status status = send_locked(std::move(value), pending);
+        if (status == Status::WOULD_BLOCK)
+        {
+            return false;
+        }
+        claim->claim();
+        pending.push_back([deliver, is_sent = status == Status::OK]() { deliver(is_sent); });
+        return true;
+    }
+
+    bool arm_recv(const std::shared_ptr<ChannelClaim>& claim, const RecvCallback& deliver, ChannelPending& pending)
+    {
+        auto box = std::make_shared<std::optional<T>>();
+        if (recv_locked(*box, pending) == Status::WOULD_BLOCK)
+        {
+            return false;
+        }
+        claim->claim();
+        pending.push_back([deliver, box]() { deliver(std::move(*box)); });
+        return true;
+    }
+
+    // 登记等待者，顺便清理已被认领的等待者
+    void park_send(std::shared_ptr<ChannelClaim> claim, T value, SendCallback deliver)
+    {
+        m_senders.erase(std::remove_if(m_senders.begin(), m_senders.end(),
+            [](const SendWaiter& waiter) { return waiter.m_claim->is_claimed(); }), m_senders.end());
+        m_senders.push_back(SendWaiter{std::move(claim), std::move(value), std::move(deliver)});
+    }
+
+    void park_recv(std::shared_ptr<ChannelClaim> claim, RecvCallback deliver)
+    {
+        m_receivers.erase(std::remove_if(m_receivers.begin(), m_receivers.end(),
+            [](const RecvWaiter& waiter) { return waiter.m_claim->is_claimed(); }), m_receivers.end());
+        m_receivers.push_back(RecvWaiter{std::move(claim), std::move(deliver)});
+    }
+
+    // 取出最多max_count个数据，不等待，需持有m_mtx
+    template<typename OutputIt>
+    size_t recv_some_locked(OutputIt& out, size_t max_count, ChannelPending& pending)
+    {
+        size_t count = 0;
+        std::optional<T> value;
+        while (count < max_count && recv_locked(value, pending) == Status::OK)
+        {
+            *out = std::move(*value);
+            ++out;
+            ++count;
+            value.reset();
+        }
+        return count;
+    }
+
+    // 在一次加锁中取出最多max_count个数据，不等待
+    template<typename OutputIt>
+    size_t recv_some(OutputIt& out, size_t max_count)
+    {
+        ChannelPending pending;
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            count = recv_some_locked(out, max_count, pending);
+        }
+        run_pending(pending);
+        return count;
+    }
+
+    // send_n_async的一轮：放入能放下的数据，剩余时为下一个数据登记等待者，发送出去后在线程池中继续下一轮
+    template<typename Pool, typename Func>
+    void send_batch(Pool& pool, std::shared_ptr<SendBatch> batch, Func func)
+    {
+        ChannelPending pending;
+        bool is_done = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            std::vector<T>& values = batch->m_values;
+            while (batch->m_next < values.size()
+                && send_locked(std::move(values[batch->m_next]), pending) == Status::OK)
+            {
+                batch->m_next++;
+            }
+            if (batch->m_next == values.size() || m_is_closed)
+            {
+                is_done = true;
+            }
+            else
+            {
+                size_t index = batch->m_next++;
+                park_send(std::make_shared<ChannelClaim>(), std::move(values[index]),
+                    [this, &pool, batch, func](bool is_sent) {
+                        when_detail::post(pool, [this, &pool, batch, func, is_sent]() {
+                            if (is_sent)
+                            {
+                                send_batch(pool, batch, func);
+                            }
+                            else
+                            {
+                                func(batch->m_next - 1);
+                            }
+                        });
+                    });
+            }
+        }
+        run_pending(pending);
+        if (is_done)
+        {
+            when_detail::post(pool, [func, sent = batch->m_next]() mutable { func(sent); });
+        }
+    }
+
+    size_t m_capacity; // 缓冲容量，为0时发送方与接收方直接交接
+    bool m_is_closed;
+    std::deque<T> m_buffer;
+    std::deque<RecvWaiter> m_receivers; // 等待中的接收方，只在缓冲为空时存在
+    std::deque<SendWaiter> m_senders; // 等待中的发送方，只在缓冲已满时存在
+    mutable std::mutex m_mtx;
+};
+
+/*
+在多个通道上等待，按添加顺序检查各分支，第一个能完成的分支执行其回调，其余分支不生效。
+运行时按地址顺序锁住所有涉及的通道，都不能完成时在每个通道上登记共用同一个认领标志的等待者，
+之后由第一个认领成功的对端操作完成该分支。每个Select只能运行一次。
+
+example:
+Select()
+    .on_recv(numbers, [](std::optional<int> v) { ... })
+    .on_recv(names, [](std::optional<std::string> v) { ... })
+    .on_send(out, 42, [](bool is_sent) { ... })
+    .run_async(pool);
+*/
+class Select
+{
+public:
+    // 接收分支，func(std::optional<T>)
+    template<typename T, typename Func>
+    Select& on_recv(Channel<T>& channel, Func func)
+    {
+        Case c;
+        c.m_mtx = &channel.m_mtx;
+        c.m_arm = [&channel, func](const std::shared_ptr<ChannelClaim>& claim, const Dispatch& dispatch,
+            ChannelPending& pending, bool is_park) {
+            typename Channel<T>::RecvCallback deliver = [func, dispatch](std::optional<T> value) {
+                auto box = std::make_shared<std::optional<T>>(std::move(value));
+                dispatch([func, box]() mutable { func(std::move(*box)); });
+            };
+            if (is_park)
+            {
+                channel.park_recv(claim, std::move(deliver));
+                return false;
+            }
+            return channel.arm_recv(claim, deliver, pending);
+        };
+        m_cases.push_back(std::move(c));
+        return *this;
+    }
+
+    // 发送分支，func(bool)，分支未被选中时value被丢弃
+    template<typename T, typename U, typename Func>
+    Select& on_send(Channel<T>& channel, U&& value, Func func)
+    {
+        auto box = std::make_shared<T>(std::forward<U>(value));
+        Case c;
+        c.m_mtx = &channel.m_mtx;
+        c.m_arm = [&channel, box, func](const std::shared_ptr<ChannelClaim>& claim, const Dispatch& dispatch,
+            ChannelPending& pending, bool is_park) {
+            typename Channel<T>::SendCallback deliver = [func, dispatch](bool is_sent) {
+                dispatch([func, is_sent]() mutable { func(is_sent); });
+            };
+            if (is_park)
+            {
+                channel.park_send(claim, std::move(*box), std::move(deliver));
+                return false;
+            }
+            return channel.arm_send(claim, *box, deliver, pending);
+        };
+        m_cases.push_back(std::move(c));
+        return *this;
+    }
+
+    // 阻塞直到某个分支完成，回调在调用线程执行；没有分支时直接返回
+    void wait()
+    {
+        if (m_cases.empty())
+        {
+            return;
+        }
+        auto promise = std::make_shared<std::promise<std::function<void()>>>();
+        std::future<std::function<void()>> result = promise->get_future();
+        arm([promise](std::function<void()> job) { promise->set_value(std::move(job)); });
+        result.get()();
+    }
+
+    // 不阻塞，某个分支完成后把它的回调作为任务提交到线程池
+    template<typename Pool>
+    void run_async(Pool& pool)
+    {
+        arm([&pool](std::function<void()> job) { when_detail::post(pool, std::move(job)); });
+    }
+private:
+    using Dispatch = std::function<void(std::function<void()>)>; // 分支完成后如何执行回调
+
+    struct Case
+    {
+        std::mutex* m_mtx;
+        // is_park为false时尝试立即完成，返回是否完成；为true时登记等待者
+        std::function<bool(const std::shared_ptr<ChannelClaim>&, const Dispatch&, ChannelPending&, bool)> m_arm;
+    };
+
+    void arm(Dispatch dispatch)
+    {
+        // 按地址顺序加锁，避免与其他Select互相死锁
+        std::vector<std::mutex*> mutexes;
+        for (const Case& c : m_cases)
+        {
+            mutexes.push_back(c.m_mtx);
+        }
+        std::sort(mutexes.begin(), mutexes.end());
+        mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
+
+        ChannelPending pending;
+        auto claim = std::make_shared<ChannelClaim>();
+        {
+            std::vector<std::unique_lock<std::mutex>> locks;
+            for (std::mutex* mtx : mutexes)
+            {
+                locks.emplace_back(*mtx);
+            }
+            bool is_done = false;
+            for (Case& c : m_cases)
+            {
+                if (c.m_arm(claim, dispatch, pending, false))
+                {
+                    is_done = true;
+                    break;
+                }
+            }
+            if (!is_done)
+            {
+                for (Case& c : m_cases)
+                {
+                    c.m_arm(claim, dispatch, pending, true);
+                }
+            }
+        }
+        run_pending(pending);
+    }
+
+    std::vector<Case> m_cases;
+};
+
+#endif
@@ -0,0 +1,343 @@
+#ifndef PARALLEL_ALGORITHM_H
+#define PARALLEL_ALGORITHM_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "when_all.h"
+
+/*
+基于线程池的并行算法：parallel_sort、parallel_inclusive_scan / parallel_exclusive_scan、
+parallel_transform、parallel_find_if、parallel_count_if。
+区间被切成若干连续的块，每块作为一个任务提交到线程池，通过when_all一次性等待全部块完成；
+元素数量低于cutoff时直接串行执行。Pool 可以是 ThreadPool 或 BasicThreadPool。
+这些函数会阻塞等待结果，应当在线程池外部的线程中调用，在工作线程中调用可能占满所有线程造成死锁。
+
+example:
+ThreadPool pool;
+pool.start(8);
+parallel_sort(pool, v.begin(), v.end());
+size_t cnt = parallel_count_if(pool, v.begin(), v.end(), [](int x){ return x % 2 == 0; });
+*/
+
+const size_t PARALLEL_SERIAL_CUTOFF = 1 << 14; // 低于该元素数量时串行执行
+
+namespace parallel_detail
+{
+    // 按元素数量与cutoff计算分块的边界，块数不超过线程数的4倍
+    inline std::vector<size_t> split(size_t n, size_t cutoff)
+    {
+        size_t max_chunks = std::max<size_t>(1, std::thread::hardware_concurrency()) * 4;
+        size_t chunks = std::max<size_t>(1, std::min(max_chunks, n / std::max<size_t>(1, cutoff)));
+        std::vector<size_t> bounds(chunks + 1);
+        for (size_t i = 0; i <= chunks; ++i)
+        {
+            bounds[i] = n * i / chunks;
+        }
+        return bounds;
+    }
+
+    // 对每个块执行fn(块下标, begin, end)，全部完成后返回，任一块抛出的异常会重新抛出
+    template<typename Pool, typename Func>
+    void for_each_chunk(Pool& pool, const std::vector<size_t>& bounds, Func fn)
+    {
+        std::vector<std::function<void()>> jobs;
+        jobs.reserve(bounds.size() - 1);
+        for (size_t i = 0; i + 1 < bounds.size(); ++i)
+        {
+            jobs.emplace_back([&fn, &bounds, i]() { fn(i, bounds[i], bounds[i + 1]); });
+        }
+        when_all(pool, jobs.begin(), jobs.end()).get();
+    }
+
+    // 把有序的[a, a_end)与[b, b_end)合并到out，较长的一段切成pieces份，
+    // 在另一段中二分查找对应的切分点，各份独立合并
+    template<typename SrcIt, typename DstIt, typename Compare>
+    void add_merge_jobs(std::vector<std::function<void()>>& jobs,
+        SrcIt a, SrcIt a_end, SrcIt b, SrcIt b_end, DstIt out, size_t pieces, Compare comp)
+    {
+        size_t a_len = a_end - a;
+        pieces = std::max<size_t>(1, std::min(pieces, a_len));
+        SrcIt b_lo = b;
+        DstIt out_lo = out;
+        for (size_t p = 0; p < pieces; ++p)
+        {
+            SrcIt a_lo = a + a_len * p / pieces;
+            SrcIt a_hi = a + a_len * (p + 1) / pieces;
+            SrcIt b_hi = p + 1 == pieces ? b_end : std::lower_bound(b_lo, b_end, *a_hi, comp);
+            jobs.emplace_back([=]() {
+                std::merge(std::make_move_iterator(a_lo), std::make_move_iterator(a_hi),
+                    std::make_move_iterator(b_lo), std::make_move_iterator(b_hi), out_lo, comp);
+            });
+            out_lo += (a_hi - a_lo) + (b_hi - b_lo);
+            b_lo = b_hi;
+        }
+    }
+
+    // 一轮归并：相邻的有序段两两合并，src中的段边界为runs
+    template<typename Pool, typename SrcIt, typename DstIt, typename Compare>
+    std::vector<size_t> merge_round(Pool& pool, SrcIt src, DstIt dst,
+        const std::vector<size_t>& runs, size_t grain, Compare comp)
+    {
+        std::vector<std::function<void()>> jobs;
+        std::vector<size_t> next;
+        next.push_back(0);
+        for (size_t r = 0; r + 1 < runs.size(); r += 2)
+        {
+            size_t lo = runs[r];
+            size_t mid = runs[r + 1];
+            if (r + 2 < runs.size())
+            {
+                size_t hi = runs[r + 2];
+                size_t pieces = (hi - lo + grain - 1) / grain;
+                add_merge_jobs(jobs, src + lo, src + mid, src + mid, src + hi, dst + lo, pieces, comp);
+                next.push_back(hi);
+            }
+            else
+            {
+                // 落单的最后一段直接搬到dst
+                jobs.emplace_back([=]() {
+                    std::move(src + lo, src + mid, dst + lo);
+                });
+                next.push_back(mid);
+            }
+        }
+        when_all(pool, jobs.begin(), jobs.end()).get();
+        return next;
+    }
+
+    // 归并排序的临时缓冲，只申请内存不初始化，元素按块移动构造进来，析构时只销毁已构造的块
+    template<typename T>
+    class ScratchBuffer
+    {
+    public:
+        explicit ScratchBuffer(const std::vector<size_t>& bounds)
+            : m_bounds(bounds)
+            , m_constructed(bounds.size() - 1, 0)
+            , m_data(std::allocator<T>().allocate(bounds.back()))
+        {}
+        ~ScratchBuffer()
+        {
+            for (size_t i = 0; i < m_constructed.size(); ++i)
+            {
+                if (m_constructed[i])
+                {
+                    std::destroy(m_data + m_bounds[i], m_data + m_bounds[i + 1]);
+                }
+            }
+            std::allocator<T>().deallocate(m_data, m_bounds.back());
+        }
+        ScratchBuffer(const ScratchBuffer&) = delete;
+        ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+        T* data()
+        {
+            return m_data;
+        }
+
+        // 把[src, src + 块长度)移动构造到第chunk块，不同的块可以并发调用
+        template<typename It>
+        void construct_chunk(size_t chunk, It src)
+        {
+            std::uninitialized_move(src, src + (m_bounds[chunk + 1] - m_bounds[chunk]), m_data + m_bounds[chunk]);
+            m_constructed[chunk] = 1;
+        }
+    private:
+        std::vector<size_t> m_bounds;
+        std::vector<char> m_constructed;
+        T* m_data;
+    };
+}
+
+// 并行排序：各块先用std::sort排序，再逐轮两两并行归并
+template<typename Pool, typename RandomIt, typename Compare = std::less<>>
+void parallel_sort(Pool& pool, RandomIt first, RandomIt last, Compare comp = Compare(),
+    size_t cutoff = PARALLEL_SERIAL_CUTOFF)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    size_t n = last - first;
+    if (n <= cutoff)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+    std::vector<size_t> runs = parallel_detail::split(n, cutoff);
+    // 各块排序后直接移动到临时缓冲，缓冲的构造分散在各块的任务中，第一轮归并从缓冲写回原区间
+    parallel_detail::ScratchBuffer<T> buf(runs);
+    parallel_detail::for_each_chunk(pool, runs, [&](size_t i, size_t lo, size_t hi) {
+        std::sort(first + lo, first + hi, comp);
+        buf.construct_chunk(i, first + lo);
+    });
+
+    size_t grain = n / (runs.size() - 1);
+    std::vector<size_t> bounds = runs;
+    bool in_buf = true;
+    while (runs.size() > 2)
+    {
+        if (in_buf)
+        {
+            runs = parallel_detail::merge_round(pool, buf.data(), first, runs, grain, comp);
+        }
+        else
+        {
+            runs = parallel_detail::merge_round(pool, first, buf.data(), runs, grain, comp);
+        }
+        in_buf = !in_buf;
+    }
+    if (in_buf)
+    {
+        parallel_detail::for_each_chunk(pool, bounds, [&](size_t, size_t lo, size_t hi) {
+            std::move(buf.data() + lo, buf.data() + hi, first + lo);
+        });
+    }
+}
+
+// 并行变换：d_first[i] = op(first[i])，返回输出区间的尾后迭代器
+template<typename Pool, typename InputIt, typename OutputIt, typename UnaryOp>
+OutputIt parallel_transform(Pool& pool, InputIt first, InputIt last, OutputIt d_first, UnaryOp op,
+    size_t cutoff = PARALLEL_SERIAL_CUTOFF)
+{
+    size_t n = last - first;
+    if (n <= cutoff)
+    {
+        return std::transform(first, last, d_first, op);
+    }
+    parallel_detail::for_each_chunk(pool, parallel_detail::split(n, cutoff), [&](size_t, size_t lo, size_t hi) {
+        std::transform(first + lo, first + hi, d_first + lo, op);
+    });
+    return d_first + n;
+}
+
+// 并行计数
+template<typename Pool, typename InputIt, typename UnaryPred>
+size_t parallel_count_if(Pool& pool, InputIt first, InputIt last, UnaryPred pred,
+    size_t cutoff = PARALLEL_SERIAL_CUTOFF)
+{
+    size_t n = last - first;
+    if (n <= cutoff)
+    {
+        return std::count_if(first, last, pred);
+    }
+    std::vector<size_t> bounds = parallel_detail::split(n, cutoff);
+    std::vector<size_t> counts(bounds.size() - 1);
+    parallel_detail::for_each_chunk(pool, bounds, [&](size_t i, size_t lo, size_t hi) {
+        counts[i] = std::count_if(first + lo, first + hi, pred);
+    });
+    return std::accumulate(counts.begin(), counts.end(), size_t(0));
+}
+
+// 并行查找第一个满足条件的元素
+// 已找到的最小下标保存在原子变量中，各块定期检查，位置在其之后的块提前结束
+template<typename Pool, typename InputIt, typename UnaryPred>
+InputIt parallel_find_if(Pool& pool, InputIt first, InputIt last, UnaryPred pred,
+    size_t cutoff = PARALLEL_SERIAL_CUTOFF)
+{
+    size_t n = last - first;
+    if (n <= cutoff)
+    {
+        return std::find_if(first, last, pred);
+    }
+    const size_t check_step = 1024; // 每扫描这么多元素检查一次是否可以提前结束
+    std::atomic_size_t found(n);
+    parallel_detail::for_each_chunk(pool, parallel_detail::split(n, cutoff), [&](size_t, size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i += check_step)
+        {
+            if (found.load(std::memory_order_relaxed) < i)
+            {
+                return;
+            }
+            size_t end = std::min(hi, i + check_step);
+            InputIt it = std::find_if(first + i, first + end, pred);
+            if (it != first + end)
+            {
+                size_t pos = it - first;
+                size_t cur = found.load(std::memory_order_relaxed);
+                while (pos < cur && !found.compare_exchange_weak(cur, pos, std::memory_order_relaxed))
+                {}
+                return;
+            }
+        }
+    });
+    return first + found.load();
+}
+
+namespace parallel_detail
+{
+    // 三阶段扫描：各块并行求和 -> 串行计算块的前缀 -> 各块带偏移并行扫描
+    template<typename Pool, typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+    OutputIt scan(Pool& pool, InputIt first, InputIt last, OutputIt d_first,
+        const T* init, BinaryOp op, bool inclusive, size_t cutoff)
+    {
+        size_t n = last - first;
+        std::vector<size_t> bounds = split(n, cutoff);
+        size_t chunks = bounds.size() - 1;
+        std::vector<T> sums(chunks);
+        for_each_chunk(pool, bounds, [&](size_t i, size_t lo, size_t hi) {
+            T sum = first[lo];
+            for (size_t k = lo + 1; k < hi; ++k)
+            {
+                sum = op(sum, first[k]);
+            }
+            sums[i] = sum;
+        });
+
+        // offsets[i]为块i之前所有元素的累计值，inclusive模式下块0没有偏移
+        std::vector<T> offsets(chunks);
+        if (init != nullptr)
+        {
+            offsets[0] = *init;
+        }
+        for (size_t i = 1; i < chunks; ++i)
+        {
+            offsets[i] = (i == 1 && init == nullptr) ? sums[0] : op(offsets[i - 1], sums[i - 1]);
+        }
+
+        for_each_chunk(pool, bounds, [&](size_t i, size_t lo, size_t hi) {
+            if (!inclusive)
+            {
+                std::exclusive_scan(first + lo, first + hi, d_first + lo, offsets[i], op);
+            }
+            else if (i == 0 && init == nullptr)
+            {
+                std::inclusive_scan(first + lo, first + hi, d_first + lo, op);
+            }
+            else
+            {
+                std::inclusive_scan(first + lo, first + hi, d_first + lo, op, offsets[i]);
+            }
+        });
+        return d_first + n;
+    }
+}
+
+// 并行前缀和（包含当前元素），op需满足结合律
+template<typename Pool, typename InputIt, typename OutputIt, typename BinaryOp = std::plus<>>
+OutputIt parallel_inclusive_scan(Pool& pool, InputIt first, InputIt last, OutputIt d_first,
+    BinaryOp op = BinaryOp(), size_t cutoff = PARALLEL_SERIAL_CUTOFF)
+{
+    using T = typename std::iterator_traits<InputIt>::value_type;
+    if (static_cast<size_t>(last - first) <= cutoff)
+    {
+        return std::inclusive_scan(first, last, d_first, op);
+    }
+    return parallel_detail::scan(pool, first, last, d_first, static_cast<const T*>(nullptr), op, true, cutoff);
+}
+
+// 并行前缀和（不包含当前元素），从init开始累计，op需满足结合律
+template<typename Pool, typename InputIt, typename OutputIt, typename T, typename BinaryOp = std::plus<>>
+OutputIt parallel_exclusive_scan(Pool& pool, InputIt first, InputIt last, OutputIt d_first, T init,
+    BinaryOp op = BinaryOp(), size_t cutoff = PARALLEL_SERIAL_CUTOFF)
+{
+    if (static_cast<size_t>(last - first) <= cutoff)
+    {
+        return std::exclusive_scan(first, last, d_first, init, op);
+    }
+    return parallel_detail::scan(pool, first, last, d_first, &init, op, false, cutoff);
+}
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "when_all.h"
+
+/*
+有界多阶段流水线 parallel_pipeline
+每个阶段可以是 SERIAL_IN_ORDER（串行且按源的顺序）、SERIAL_OUT_OF_ORDER（串行但不保证顺序）或 PARALLEL（可并行）。
+run时指定同时在途的数据（token）上限：最多只有max_tokens个数据在流水线中，源阶段只有在有空闲token时才会被调用，
+下游变慢时上游自然停下，内存不会无限增长。
+每个token由一个任务从源阶段一直带到最后一个阶段，数据尽量留在同一个工作线程上；
+只有遇到正被占用的串行阶段时token才会挂起，工作线程去做别的事情，该阶段空闲后再把token重新提交到线程池。
+阶段之间的数据通过std::any传递，需要可拷贝构造。run会阻塞等待流水线结束，应当在线程池外部调用。
+
+example:
+Pipeline pipeline;
+pipeline.add_source([&]() -> std::optional<std::string> { return read_line(file); })
+    .add_stage<std::string>(StageMode::PARALLEL, [](std::string line) { return parse(line); })
+    .add_stage<Record>(StageMode::PARALLEL, [](Record r) { return transform(r); })
+    .add_stage<Record>(StageMode::SERIAL_IN_ORDER, [&](Record r) { write(out, r); });
+pipeline.run(pool, 16);
+*/
+
+// 流水线阶段的执行方式
+enum class StageMode
+{
+    SERIAL_IN_ORDER, // 串行，按源阶段产生的顺序处理
+    SERIAL_OUT_OF_ORDER, // 串行，先到先处理
+    PARALLEL, // 可以同时处理多个数据
+};
+
+class Pipeline
+{
+public:
+    // 设置源阶段，func返回std::optional<T>，返回std::nullopt表示数据结束；源阶段总是串行调用
+    template<typename Func>
+    Pipeline& add_source(Func func)
+    {
+        using Opt = std::invoke_result_t<Func&>;
+        m_source = [func = std::move(func)](std::any& item) mutable -> bool {
+            Opt value = func();
+            if (!value)
+            {
+                return false;
+            }
+            item = std::move(*value);
+            return true;
+        };
+        return *this;
+    }
+
+    // 添加一个阶段，In为上一阶段输出的类型，func返回void时该阶段为终点，之后不再传递数据
+    template<typename In, typename Func>
+    Pipeline& add_stage(StageMode mode, Func func)
+    {
+        using Out = std::invoke_result_t<Func&, In&&>;
+        m_stages.push_back(Stage{mode, [func = std::move(func)](std::any& item) mutable {
+            // 类型与上一阶段的输出不符时抛出std::bad_any_cast，经由fail记录到run的结果中
+            In& in = std::any_cast<In&>(item);
+            if constexpr (std::is_void_v<Out>)
+            {
+                func(std::move(in));
+                item.reset();
+            }
+            else
+            {
+                item = func(std::move(in));
+            }
+        }});
+        return *this;
+    }
+
+    // 启动流水线，最多max_tokens个数据同时在途，返回的future在全部数据处理完后就绪
+    // 任一阶段抛出异常后不再读取新数据，已在途的数据跳过剩余阶段，future中保存第一个异常
+    template<typename Pool>
+    std::future<void> run_async(Pool& pool, size_t max_tokens)
+    {
+        max_tokens = std::max<size_t>(1, max_tokens);
+        auto state = std::make_shared<RunState>(m_source, m_stages, max_tokens);
+        std::future<void> result = state->m_promise.get_future();
+        for (size_t i = 0; i < max_tokens; ++i)
+        {
+            when_detail::post(pool, [state, &pool]() { drive(state, pool, Token(), 0); });
+        }
+        return result;
+    }
+
+    // 启动流水线并等待结束
+    template<typename Pool>
+    void run(Pool& pool, size_t max_tokens)
+    {
+        run_async(pool, max_tokens).get();
+    }
+
+private:
+    using StageFunc = std::function<void(std::any&)>;
+
+    struct Stage
+    {
+        StageMode m_mode;
+        StageFunc m_func;
+    };
+
+    // 在途的数据
+    struct Token
+    {
+        size_t m_seq = 0; // 源阶段产生的序号
+        bool m_is_valid = false; // 是否持有数据
+        std::any m_item;
+    };
+
+    // 串行阶段的状态
+    struct SerialState
+    {
+        std::mutex m_mtx;
+        bool m_is_busy = false; // 是否有token正在该阶段执行
+        size_t m_next_seq = 0; // SERIAL_IN_ORDER下一个允许进入的序号
+        size_t m_arrival = 0; // SERIAL_OUT_OF_ORDER的到达计数
+        std::map<size_t, Token> m_pending; // 挂起的token，按序号或到达顺序排列
+    };
+
+    // 一次运行的共享状态
+    struct RunState
+    {
+        RunState(std::function<bool(std::any&)> source, std::vector<Stage> stages, size_t max_tokens)
+            : m_source(std::move(source))
+            , m_stages(std::move(stages))
+            , m_serial(m_stages.size())
+            , m_next_seq(0)
+            , m_is_source_done(false)
+            , m_active_loops(max_tokens)
+            , m_failed(false)
+        {}
+
+        std::function<bool(std::any&)> m_source;
+        std::vector<Stage> m_stages;
+        std::vector<SerialState> m_serial;
+
+        std::mutex m_source_mtx; // 源阶段串行调用
+        size_t m_next_seq;
+        bool m_is_source_done;
+
+        std::atomic_size_t m_active_loops; // 尚未结束的token循环，挂起的也计算在内
+        std::atomic_bool m_failed;
+        std::exception_ptr m_error;
+        std::promise<void> m_promise;
+    };
+
+    // 记录第一个异常
+    static void fail(RunState& state)
+    {
+        if (!state.m_failed.exchange(true))
+        {
+            state.m_error = std::current_exception();
+        }
+    }
+
+    // 从源阶段取下一个数据
+    static bool pull(RunState& state, Token& token)
+    {
+        std::lock_guard<std::mutex> lock(state.m_source_mtx);
+        if (state.m_is_source_done || state.m_failed.load() || !state.m_source)
+        {
+            return false;
+        }
+        try
+        {
+            if (!state.m_source(token.m_item))
+            {
+                state.m_is_source_done = true;
+                return false;
+            }
+        }
+        catch (...)
+        {
+            state.m_is_source_done = true;
+            fail(state);
+            return false;
+        }
+        token.m_seq = state.m_next_seq++;
+        token.m_is_valid = true;
+        return true;
+    }
+
+    // 执行一个阶段，出错后token继续流过剩余的阶段但不再执行，保证串行有序阶段的序号连续
+    static void execute(RunState& state, Stage& stage, Token& token)
+    {
+        if (state.m_failed.load())
+        {
+            return;
+        }
+        try
+        {
+            stage.m_func(token.m_item);
+        }
+        catch (...)
+        {
+            fail(state);
+        }
+    }
+
+    // token循环：取数据 -> 依次通过各阶段 -> 再取下一个数据，直到源阶段结束
+    // 从stage开始继续处理token，用于挂起后恢复
+    template<typename Pool>
+    static void drive(std::shared_ptr<RunState> state, Pool& pool, Token token, size_t stage)
+    {
+        while (true)
+        {
+            if (!token.m_is_valid)
+            {
+                if (!pull(*state, token))
+                {
+                    break;
+                }
+                stage = 0;
+            }
+            for (; stage < state->m_stages.size(); ++stage)
+            {
+                Stage& st = state->m_stages[stage];
+                if (st.m_mode == StageMode::PARALLEL)
+                {
+                    execute(*state, st, token);
+                    continue;
+                }
+
+                SerialState& serial = state->m_serial[stage];
+                {
+                    std::lock_guard<std::mutex> lock(serial.m_mtx);
+                    if (serial.m_is_busy
+                        || (st.m_mode == StageMode::SERIAL_IN_ORDER && token.m_seq != serial.m_next_seq))
+                    {
+                        // 阶段被占用或还没轮到，挂起token，当前工作线程去处理其他任务
+                        size_t key = st.m_mode == StageMode::SERIAL_IN_ORDER ? token.m_seq : serial.m_arrival++;
+                        serial.m_pending.emplace(key, std::move(token));
+                        return;
+                    }
+                    serial.m_is_busy = true;
+                }
+
+                execute(*state, st, token);
+
+                Token resume;
+                {
+                    std::lock_guard<std::mutex> lock(serial.m_mtx);
+                    serial.m_is_busy = false;
+                    if (st.m_mode == StageMode::SERIAL_IN_ORDER)
+                    {
+                        serial.m_next_seq++;
+                    }
+                    auto it = st.m_mode == StageMode::SERIAL_IN_ORDER
+                        ? serial.m_pending.find(serial.m_next_seq)
+                        : serial.m_pending.begin();
+                    if (it != serial.m_pending.end())
+                    {
+                        resume = std::move(it->second);
+                        serial.m_pending.erase(it);
+                    }
+                }
+                if (resume.m_is_valid)
+                {
+                    // 把挂起在该阶段的下一个token重新交给线程池
+                    when_detail::post(pool, [state, &pool, stage, resume = std::move(resume)]() mutable {
+                        drive(state, pool, std::move(resume), stage);
+                    });
+                }
+            }
+            token = Token();
+        }
+
+        // 最后一个结束的token循环通知等待方
+        if (state->m_active_loops.fetch_sub(1) == 1)
+        {
+            if (state->m_error)
+            {
+                state->m_promise.set_exception(state->m_error);
+            }
+            else
+            {
+                state->m_promise.set_value();
+            }
+        }
+    }
+
+private:
+    std::function<bool(std::any&)> m_source; // 源阶段
+    std::vector<Stage> m_stages; // 源阶段之后的各个阶段
+};
+
+#endif
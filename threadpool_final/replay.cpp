@@ -0,0 +1,191 @@
+#define THREADPOOL_QUIET
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include "threadpool.h"
+#include "capture.h"
+/*
+任务负载回放工具
+读取ThreadPool::start_capture录制的文件，按原来的到达时间向指定配置的线程池提交自旋任务，
+每个任务自旋录制下来的执行耗时，最后输出吞吐量、排队等待时间分位数以及线程数量随时间的变化，
+用于离线比较不同的线程池参数。
+
+编译：g++ -std=c++17 -O2 replay.cpp -o replay -pthread
+用法：./replay <录制文件> [--mode fixed|cached] [--threads N] [--task-max N] [--thread-max N]
+                          [--idle-time 秒] [--speed 倍数]
+*/
+
+struct ReplayConfig
+{
+    std::string path;
+    PoolMode mode = PoolMode::MODE_FIXED;
+    size_t threads = std::thread::hardware_concurrency();
+    size_t task_max = TASK_MAX_THRESHHOLD;
+    size_t thread_max = THREAD_MAX_THRESHHOLD;
+    int idle_time = THREAD_MAX_IDLE_TIME;
+    double speed = 1.0; // 回放速度，2表示到达间隔缩短一半
+};
+
+bool parse_args(int argc, char** argv, ReplayConfig& config)
+{
+    if (argc < 2)
+    {
+        return false;
+    }
+    config.path = argv[1];
+    for (int i = 2; i < argc; i += 2)
+    {
+        std::string key = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value for option: " << key << std::endl;
+            return false;
+        }
+        std::string value = argv[i + 1];
+        if (key == "--mode")
+        {
+            config.mode = value == "cached" ? PoolMode::MODE_CACHED : PoolMode::MODE_FIXED;
+        }
+        else if (key == "--threads")
+        {
+            config.threads = strtoul(value.c_str(), nullptr, 10);
+        }
+        else if (key == "--task-max")
+        {
+            config.task_max = strtoul(value.c_str(), nullptr, 10);
+        }
+        else if (key == "--thread-max")
+        {
+            config.thread_max = strtoul(value.c_str(), nullptr, 10);
+        }
+        else if (key == "--idle-time")
+        {
+            config.idle_time = atoi(value.c_str());
+        }
+        else if (key == "--speed")
+        {
+            config.speed = atof(value.c_str());
+        }
+        else
+        {
+            std::cerr << "unknown option: " << key << std::endl;
+            return false;
+        }
+    }
+    return config.speed > 0;
+}
+
+// 忙等ns纳秒，模拟录制下来的任务执行耗时
+void spin_for(uint64_t ns)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+    while (std::chrono::steady_clock::now() < end)
+    {}
+}
+
+// 已排序数据的分位数
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+int main(int argc, char** argv)
+{
+    ReplayConfig config;
+    if (!parse_args(argc, argv, config))
+    {
+        std::cerr << "usage: " << argv[0] << " <capture file> [--mode fixed|cached] [--threads N]"
+            << " [--task-max N] [--thread-max N] [--idle-time seconds] [--speed factor]" << std::endl;
+        return 1;
+    }
+    std::vector<CaptureRecord> records;
+    if (!read_capture(config.path, records) || records.empty())
+    {
+        std::cerr << "cannot read capture file: " << config.path << std::endl;
+        return 1;
+    }
+    std::sort(records.begin(), records.end(), [](const CaptureRecord& a, const CaptureRecord& b) {
+        return a.m_submit_ns < b.m_submit_ns;
+    });
+
+    std::vector<uint64_t> waits(records.size()); // 每个任务从计划提交到开始执行的时间
+    std::vector<char> executed(records.size(), 0); // 任务是否真正执行，提交失败的任务返回的future直接就绪，不会执行
+    std::vector<std::future<void>> results;
+    results.reserve(records.size());
+    std::vector<std::pair<double, size_t>> thread_timeline; // <秒, 线程数>
+    auto begin = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool;
+        pool.set_mode(config.mode);
+        pool.set_task_que_max_thresh_hold(config.task_max);
+        pool.set_thread_size_thresh_hold(config.thread_max);
+        pool.set_thread_max_idle_time(config.idle_time);
+        pool.start(config.threads);
+
+        // 每100ms采样一次线程数量
+        std::atomic_bool is_sampling(true);
+        std::thread sampler([&]() {
+            while (is_sampling)
+            {
+                double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                thread_timeline.emplace_back(t, pool.thread_size());
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        });
+
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            const CaptureRecord& record = records[i];
+            auto planned = begin + std::chrono::nanoseconds(static_cast<uint64_t>(record.m_submit_ns / config.speed));
+            std::this_thread::sleep_until(planned);
+            uint64_t run_ns = record.m_run_ns;
+            results.push_back(pool.submitTaskTagged(record.m_tenant_id, record.m_tag, [&waits, &executed, i, planned, run_ns]() {
+                executed[i] = 1;
+                waits[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - planned).count();
+                spin_for(run_ns);
+            }));
+        }
+        for (auto& result : results)
+        {
+            result.get();
+        }
+        is_sampling = false;
+        sampler.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // 被拒绝的任务不计入吞吐量和等待时间分位数
+    std::vector<uint64_t> executed_waits;
+    executed_waits.reserve(records.size());
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (executed[i])
+        {
+            executed_waits.push_back(waits[i]);
+        }
+    }
+    std::sort(executed_waits.begin(), executed_waits.end());
+    std::cout << "tasks: " << executed_waits.size() << "\trejected: " << records.size() - executed_waits.size()
+        << "\telapsed: " << elapsed << " s"
+        << "\tthroughput: " << executed_waits.size() / elapsed << " tasks/s" << std::endl;
+    std::cout << "queue wait(us)\tp50 " << percentile(executed_waits, 0.5) / 1000
+        << "\tp90 " << percentile(executed_waits, 0.9) / 1000
+        << "\tp99 " << percentile(executed_waits, 0.99) / 1000
+        << "\tmax " << percentile(executed_waits, 1.0) / 1000 << std::endl;
+    std::cout << "threads over time(s: threads)" << std::endl;
+    for (auto& sample : thread_timeline)
+    {
+        std::cout << sample.first << ": " << sample.second << std::endl;
+    }
+}
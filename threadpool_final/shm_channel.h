@@ -0,0 +1,454 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/*
+跨进程的共享内存任务通道
+同一台机器上的多个进程各自运行线程池时，部分核心过载而另一部分空闲。
+ShmTaskChannel 在 shm_open 或 memfd 创建的共享内存中放置一个有界无锁环形队列（Vyukov MPMC），
+生产者进程写入任务描述（已注册的处理函数id + 内联的负载数据），
+消费者进程中的 ShmTaskConsumer 取出任务描述，交给本进程的线程池与本地任务一起执行。
+队列为空时消费者通过futex睡眠，生产者只在有消费者睡眠时才进行唤醒的系统调用。
+
+example:
+// 消费者进程
+auto channel = ShmTaskChannel::create("/my_tasks", 4096);
+ShmTaskConsumer<ThreadPool> consumer(*channel, pool);
+consumer.register_handler(1, [](const char* data, size_t size) { ... });
+consumer.start();
+// 生产者进程
+auto channel = ShmTaskChannel::open("/my_tasks");
+channel->push(1, &request, sizeof(request));
+*/
+
+const size_t SHM_PAYLOAD_SIZE = 240; // 每个任务描述内联负载的上限，单位：字节
+const uint64_t SHM_CHANNEL_MAGIC = 0x54504348414e3031ULL; // "TPCHAN01"
+
+// 从通道中取出的任务描述
+struct ShmMessage
+{
+    uint32_t m_handler_id; // 处理函数id
+    uint32_t m_size; // 负载长度
+    char m_payload[SHM_PAYLOAD_SIZE];
+};
+
+class ShmTaskChannel
+{
+public:
+    // 通过shm_open创建具名通道，capacity向上取整为2的幂，已存在的同名通道会被重新初始化
+    static std::unique_ptr<ShmTaskChannel> create(const std::string& name, size_t capacity)
+    {
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            std::cerr << "shm_open " << name << " fail: " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+        return init(fd, capacity);
+    }
+
+    // 通过memfd创建匿名通道，fork后的子进程可以直接使用，或者把fd传给其他进程后通过open_fd打开
+    static std::unique_ptr<ShmTaskChannel> create_memfd(size_t capacity)
+    {
+        int fd = memfd_create("threadpool_channel", 0);
+        if (fd < 0)
+        {
+            std::cerr << "memfd_create fail: " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+        return init(fd, capacity);
+    }
+
+    // 打开已存在的具名通道
+    static std::unique_ptr<ShmTaskChannel> open(const std::string& name)
+    {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0)
+        {
+            std::cerr << "shm_open " << name << " fail: " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+        return open_fd(fd);
+    }
+
+    // 通过文件描述符打开通道，通道接管fd
+    static std::unique_ptr<ShmTaskChannel> open_fd(int fd)
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+        {
+            ::close(fd);
+            return nullptr;
+        }
+        return map(fd, st.st_size, false, 0);
+    }
+
+    // 删除具名通道，已经打开的进程不受影响
+    static void unlink(const std::string& name)
+    {
+        shm_unlink(name.c_str());
+    }
+
+    ~ShmTaskChannel()
+    {
+        munmap(m_header, m_map_size);
+        ::close(m_fd);
+    }
+    ShmTaskChannel(const ShmTaskChannel&) = delete;
+    ShmTaskChannel& operator=(const ShmTaskChannel&) = delete;
+
+    int fd() const
+    {
+        return m_fd;
+    }
+
+    // 写入一个任务描述，队列满或负载过长时返回false
+    bool try_push(uint32_t handler_id, const void* data, size_t size)
+    {
+        if (size > SHM_PAYLOAD_SIZE)
+        {
+            return false;
+        }
+        uint64_t pos = m_header->m_enqueue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true)
+        {
+            slot = &m_slots[pos & m_mask];
+            uint64_t seq = slot->m_seq.load(std::memory_order_acquire);
+            int64_t dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (dif == 0)
+            {
+                if (m_header->m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (dif < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_header->m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->m_message.m_handler_id = handler_id;
+        slot->m_message.m_size = static_cast<uint32_t>(size);
+        memcpy(slot->m_message.m_payload, data, size);
+        slot->m_seq.store(pos + 1, std::memory_order_release);
+        wake_consumer();
+        return true;
+    }
+
+    // 写入一个任务描述，队列满时让出CPU后重试，负载过长时返回false
+    bool push(uint32_t handler_id, const void* data, size_t size)
+    {
+        if (size > SHM_PAYLOAD_SIZE)
+        {
+            return false;
+        }
+        while (!try_push(handler_id, data, size))
+        {
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // 取出一个任务描述，队列为空时返回false；长度超出负载上限的任务描述会被丢弃
+    bool try_pop(ShmMessage& message)
+    {
+        uint64_t pos = m_header->m_dequeue_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot* slot = &m_slots[pos & m_mask];
+            uint64_t seq = slot->m_seq.load(std::memory_order_acquire);
+            int64_t dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+            if (dif == 0)
+            {
+                if (!m_header->m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    continue;
+                }
+                // 长度来自共享内存，不能信任对端进程，超出上限时释放槽位并跳过
+                uint32_t size = slot->m_message.m_size;
+                if (size <= SHM_PAYLOAD_SIZE)
+                {
+                    message.m_handler_id = slot->m_message.m_handler_id;
+                    message.m_size = size;
+                    memcpy(message.m_payload, slot->m_message.m_payload, size);
+                }
+                slot->m_seq.store(pos + m_mask + 1, std::memory_order_release);
+                if (size <= SHM_PAYLOAD_SIZE)
+                {
+                    return true;
+                }
+                std::cerr << "drop bad task message, size: " << size << std::endl;
+                pos = m_header->m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+            else if (dif < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_header->m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 队列为空时通过futex睡眠，直到有新的任务描述或超时，返回队列是否非空
+    bool wait(std::chrono::milliseconds timeout)
+    {
+        uint32_t seen = m_header->m_futex.load();
+        m_header->m_waiters.fetch_add(1);
+        // 与wake_consumer中的栅栏配对：要么生产者看到等待者，要么这里看到新数据
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (empty())
+        {
+            struct timespec ts;
+            ts.tv_sec = timeout.count() / 1000;
+            ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->m_futex), FUTEX_WAIT, seen, &ts, nullptr, 0);
+        }
+        m_header->m_waiters.fetch_sub(1);
+        return !empty();
+    }
+
+    // 唤醒所有睡眠的消费者，用于关闭消费者
+    void wake_all()
+    {
+        m_header->m_futex.fetch_add(1);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->m_futex), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    bool empty() const
+    {
+        uint64_t pos = m_header->m_dequeue_pos.load(std::memory_order_relaxed);
+        return m_slots[pos & m_mask].m_seq.load(std::memory_order_acquire) != pos + 1;
+    }
+private:
+    // 共享内存的头部，生产者、消费者的位置与futex分别放在不同的缓存行
+    struct Header
+    {
+        uint64_t m_magic;
+        uint64_t m_capacity;
+        alignas(64) std::atomic<uint64_t> m_enqueue_pos;
+        alignas(64) std::atomic<uint64_t> m_dequeue_pos;
+        alignas(64) std::atomic<uint32_t> m_futex; // 每次需要唤醒时加一
+        std::atomic<uint32_t> m_waiters; // 睡眠中的消费者数量
+    };
+
+    struct Slot
+    {
+        std::atomic<uint64_t> m_seq;
+        ShmMessage m_message;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory atomics must be lock free");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bits");
+
+    ShmTaskChannel(int fd, Header* header, size_t map_size)
+        : m_fd(fd)
+        , m_header(header)
+        , m_slots(reinterpret_cast<Slot*>(header + 1))
+        , m_mask(header->m_capacity - 1)
+        , m_map_size(map_size)
+    {}
+
+    static std::unique_ptr<ShmTaskChannel> init(int fd, size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        size_t map_size = sizeof(Header) + size * sizeof(Slot);
+        if (ftruncate(fd, map_size) != 0)
+        {
+            std::cerr << "ftruncate fail: " << strerror(errno) << std::endl;
+            ::close(fd);
+            return nullptr;
+        }
+        return map(fd, map_size, true, size);
+    }
+
+    static std::unique_ptr<ShmTaskChannel> map(int fd, size_t map_size, bool is_create, size_t capacity)
+    {
+        void* addr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            std::cerr << "mmap fail: " << strerror(errno) << std::endl;
+            ::close(fd);
+            return nullptr;
+        }
+        Header* header = static_cast<Header*>(addr);
+        if (is_create)
+        {
+            new (header) Header();
+            header->m_capacity = capacity;
+            header->m_enqueue_pos.store(0);
+            header->m_dequeue_pos.store(0);
+            header->m_futex.store(0);
+            header->m_waiters.store(0);
+            Slot* slots = reinterpret_cast<Slot*>(header + 1);
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                new (&slots[i].m_seq) std::atomic<uint64_t>(i);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            header->m_magic = SHM_CHANNEL_MAGIC;
+        }
+        else if (header->m_magic != SHM_CHANNEL_MAGIC
+            || header->m_capacity == 0
+            || (header->m_capacity & (header->m_capacity - 1)) != 0
+            || header->m_capacity > (map_size - sizeof(Header)) / sizeof(Slot))
+        {
+            std::cerr << "shared memory is not a task channel" << std::endl;
+            munmap(addr, map_size);
+            ::close(fd);
+            return nullptr;
+        }
+        return std::unique_ptr<ShmTaskChannel>(new ShmTaskChannel(fd, header, map_size));
+    }
+
+    // 有消费者在睡眠时才进行唤醒的系统调用
+    void wake_consumer()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_header->m_waiters.load(std::memory_order_relaxed) > 0)
+        {
+            m_header->m_futex.fetch_add(1);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->m_futex), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+        }
+    }
+
+    int m_fd;
+    Header* m_header;
+    Slot* m_slots;
+    uint64_t m_mask;
+    size_t m_map_size;
+};
+
+// 消费者：取出通道中的任务描述，按处理函数id交给线程池执行
+template<typename Pool>
+class ShmTaskConsumer
+{
+public:
+    using Handler = std::function<void(const char* data, size_t size)>;
+
+    ShmTaskConsumer(ShmTaskChannel& channel, Pool& pool)
+        : m_channel(channel)
+        , m_pool(pool)
+        , m_is_running(false)
+    {}
+    ~ShmTaskConsumer()
+    {
+        stop();
+    }
+    ShmTaskConsumer(const ShmTaskConsumer&) = delete;
+    ShmTaskConsumer& operator=(const ShmTaskConsumer&) = delete;
+
+    // 注册处理函数，需在start之前调用
+    void register_handler(uint32_t handler_id, Handler handler)
+    {
+        m_handlers[handler_id] = std::make_shared<const Handler>(std::move(handler));
+    }
+
+    // 启动分发线程
+    void start()
+    {
+        if (m_is_running)
+        {
+            return;
+        }
+        m_is_running = true;
+        m_thread = std::thread([this]() { dispatch(); });
+    }
+
+    // 停止分发线程，已经交给线程池的任务持有处理函数的副本，消费者析构后仍可正常执行
+    void stop()
+    {
+        if (!m_is_running.exchange(false))
+        {
+            return;
+        }
+        m_channel.wake_all();
+        m_thread.join();
+    }
+private:
+    void dispatch()
+    {
+        ShmMessage message;
+        while (m_is_running)
+        {
+            if (!m_channel.try_pop(message))
+            {
+                m_channel.wait(std::chrono::milliseconds(100));
+                continue;
+            }
+            auto it = m_handlers.find(message.m_handler_id);
+            if (it == m_handlers.end())
+            {
+                std::cerr << "unknown handler id: " << message.m_handler_id << std::endl;
+                continue;
+            }
+            submit(it->second, std::make_shared<ShmMessage>(message));
+        }
+    }
+
+    // 提交到线程池，线程池队列已满导致提交失败时重试，期间不再从通道取任务，
+    // 通道被填满后生产者的push会等待，背压由此传回生产者，已取出的任务描述不会丢失。
+    // 重试时消费者被停止，则在分发线程上直接执行
+    void submit(std::shared_ptr<const Handler> handler, std::shared_ptr<ShmMessage> data)
+    {
+        while (true)
+        {
+            // submitTask失败时返回已就绪的空future，通过认领标志区分任务是已经执行完还是被拒绝
+            auto claimed = std::make_shared<std::atomic_bool>(false);
+            auto result = m_pool.submitTask([claimed, handler, data]() {
+                if (!claimed->exchange(true))
+                {
+                    (*handler)(data->m_payload, data->m_size);
+                }
+            });
+            if (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready
+                || claimed->exchange(true))
+            {
+                return;
+            }
+            if (!m_is_running)
+            {
+                (*handler)(data->m_payload, data->m_size);
+                return;
+            }
+        }
+    }
+
+    ShmTaskChannel& m_channel;
+    Pool& m_pool;
+    std::unordered_map<uint32_t, std::shared_ptr<const Handler>> m_handlers; // 任务捕获shared_ptr，不依赖消费者的生命周期
+    std::atomic_bool m_is_running;
+    std::thread m_thread;
+};
+
+#endif
@@ -13,10 +13,29 @@
 #include <thread>
 #include <future>
 #include <iostream>
+#include <deque>
+#include <algorithm>
+#include <time.h>
+#include <pthread.h>
+#include <alloca.h>
+#include <string>
+#include <system_error>
+#include "bump_arena.h"
+#include "capture.h"
 
 const int TASK_MAX_THRESHHOLD = 1024;
 const int THREAD_MAX_THRESHHOLD = 100;
 const int THREAD_MAX_IDLE_TIME = 60; //单位：秒
+const int DEFAULT_TENANT_ID = 0; // submitTask使用的默认租户
+const long long TENANT_QUANTUM_NS = 1000000; // 权重为1的租户每轮的执行时间配额，单位：纳秒
+const size_t STACK_WARM_UP_SIZE = 64 * 1024; // 预热时预先写入的栈空间，单位：字节
+
+// 调试输出，定义THREADPOOL_QUIET后关闭，基准测试与回放时避免输出影响测量
+#ifdef THREADPOOL_QUIET
+#define THREADPOOL_LOG(msg)
+#else
+#define THREADPOOL_LOG(msg) std::cout << msg << std::endl
+#endif
 
 
 // 线程池支持的模式
@@ -32,20 +51,34 @@ class Thread
 public:
     using ThreadFunc = std::function<void(int)>;
     
-    Thread(ThreadFunc func)
+    // thread_id由所属的线程池分配，在池内从0开始连续编号
+    Thread(ThreadFunc func, int thread_id)
     :m_func(func)
-    // 冲突？
-    , m_thread_id(m_generate_id++)
+    , m_thread_id(thread_id)
     {
 
     }
     ~Thread() = default;
-    // 启动线程
-    void start()
+    // 启动线程，stack_size为0时使用系统默认的栈大小，name非空时设置线程名（最长15个字符）
+    void start(size_t stack_size = 0, const std::string& name = "")
     {
-        // 创建一个线程来执行一个线程函数
-        std::thread t(m_func, m_thread_id);
-        t.detach(); // 设置分离线程
+        // 创建一个分离线程来执行线程函数，通过pthread属性设置栈大小
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (stack_size > 0)
+        {
+            pthread_attr_setstacksize(&attr, std::max<size_t>(stack_size, PTHREAD_STACK_MIN));
+        }
+        auto arg = new StartArg{m_func, m_thread_id, name.substr(0, 15)};
+        pthread_t tid;
+        int err = pthread_create(&tid, &attr, &Thread::entry, arg);
+        pthread_attr_destroy(&attr);
+        if (err != 0)
+        {
+            delete arg;
+            throw std::system_error(err, std::generic_category(), "pthread_create");
+        }
     }
 
     // 获取线程id
@@ -54,24 +87,54 @@ public:
         return m_thread_id;
     }
 private:
+    struct StartArg
+    {
+        ThreadFunc m_func;
+        int m_thread_id;
+        std::string m_name;
+    };
+
+    static void* entry(void* p)
+    {
+        std::unique_ptr<StartArg> arg(static_cast<StartArg*>(p));
+        if (!arg->m_name.empty())
+        {
+            pthread_setname_np(pthread_self(), arg->m_name.c_str());
+        }
+        arg->m_func(arg->m_thread_id);
+        return nullptr;
+    }
+
     ThreadFunc m_func;
-    static int m_generate_id;
     int m_thread_id; //保存线程id
 };
 
-int Thread::m_generate_id = 0;
+// 租户的统计信息
+struct TenantStats
+{
+    size_t queued; // 排队中的任务数量
+    size_t running; // 正在执行的任务数量
+    std::chrono::nanoseconds cpu_time; // 已消耗的线程CPU时间
+};
+
 // 线程池类型
 class ThreadPool
 {
 public:
     ThreadPool()
-        : m_init_thread_size(0)
+        : m_next_thread_id(0)
+        , m_init_thread_size(0)
         , m_task_size(0)
         , m_idle_thread_size(0)
         , m_cur_thread_size(0)
         , m_task_que_max_thresh_hold(TASK_MAX_THRESHHOLD)
         , m_thread_size_thresh_hold(THREAD_MAX_THRESHHOLD)
         , m_pool_mode(PoolMode::MODE_FIXED) 
+        , m_thread_max_idle_time(THREAD_MAX_IDLE_TIME)
+        , m_stack_size(0)
+        , m_is_lazy_start(false)
+        , m_is_warm_up(false)
+        , m_ready_thread_size(0)
         , m_is_pool_running(false)
     {}
 
@@ -81,6 +144,8 @@ public:
         std::unique_lock<std::mutex> lock(m_task_que_mtx);
         m_not_empty.notify_all();
         m_exit_cond.wait(lock, [&]()->bool{return m_threads.size() == 0;});
+        lock.unlock();
+        stop_capture();
     }
 
     // 设置工作模式
@@ -98,19 +163,48 @@ public:
     // 函数值类型通过auto + decltype进行类型推导
     template<typename Func, typename... Args>
     auto submitTask(Func&& func, Args&&... args) -> std::future<decltype(func(args...))>
+    {
+        return submitTaskTo(DEFAULT_TENANT_ID, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    // 向指定租户的子队列提交任务，每个租户的子队列有各自的上限，互不挤占
+    template<typename Func, typename... Args>
+    auto submitTaskTo(int tenant_id, Func&& func, Args&&... args) -> std::future<decltype(func(args...))>
+    {
+        return submitTaskTagged(tenant_id, 0, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    // 提交带类别标签的任务，标签只用于负载录制，便于回放时区分不同类别的任务
+    template<typename Func, typename... Args>
+    auto submitTaskTagged(int tenant_id, uint32_t tag, Func&& func, Args&&... args) -> std::future<decltype(func(args...))>
     {
         // 打包任务，放入任务队列中
         using RType = decltype(func(args...));
-        auto task = std::make_shared<std::packaged_task<RType()>>(
-            std::bind(std::forward<Func>(func), std::forward<Args>(args)...));
+        auto bound = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
+        std::shared_ptr<std::packaged_task<RType()>> task;
+        long long submit_ns = capture_now_ns();
+        if (submit_ns >= 0)
+        {
+            // 录制时在任务函数返回前写入记录，future就绪时该任务的记录已经写入，之后stop_capture不会丢失
+            task = std::make_shared<std::packaged_task<RType()>>(
+                [this, bound = std::move(bound), submit_ns, tag, tenant_id]() mutable -> RType {
+                    CaptureScope scope(*this, submit_ns, tag, tenant_id);
+                    return bound();
+                });
+        }
+        else
+        {
+            task = std::make_shared<std::packaged_task<RType()>>(std::move(bound));
+        }
         std::future<RType> result = task->get_future();
         // 获取锁
         std::unique_lock<std::mutex> lock(m_task_que_mtx);
-        // 线程的通信，等待任务队列有空余
+        TenantQueue& tenant = get_tenant(tenant_id);
+        // 线程的通信，等待该租户的子队列有空余
         // 用户提交任务，最长不能阻塞超过1s，否则判断提交任务失败，返回
         if (!m_not_full.wait_for(lock, 
             std::chrono::seconds(1),
-            [&]()->bool{return m_task_que.size() < m_task_que_max_thresh_hold;}))
+            [&]()->bool{return tenant.m_task_que.size() < tenant.m_max_thresh_hold;}))
         {
             std::cerr << "task queue is full, submit task fail." << std::endl;
             //return task->get_result(); // 不可以这样封装，由于task任务在掉用完成后便会进行析构，那么get_result方法中的result也就没用了，生命周期问题
@@ -121,25 +215,37 @@ public:
         }
 
         // 如果有空余，把任务让乳任务队列中,通过增加中间层来进行返回值类型的去除
-        m_task_que.emplace([task](){
+        tenant.m_task_que.emplace(QueuedTask{[task](){
             // 去执行下面的任务
             (*task)();
-        });
+        }});
+        if (!tenant.m_is_active)
+        {
+            // 子队列由空变为非空，加入轮转列表
+            tenant.m_is_active = true;
+            m_active_tenants.push_back(tenant_id);
+        }
         m_task_size++;
         m_not_empty.notify_all();
         
-        if (m_pool_mode == PoolMode::MODE_CACHED
+        // cached模式最多增长到线程数量上限阈值；延迟启动时按需创建，直到初始线程数量
+        size_t thread_limit = m_pool_mode == PoolMode::MODE_CACHED
+            ? m_thread_size_thresh_hold
+            : m_init_thread_size;
+        if (m_is_pool_running
             && m_task_size > m_idle_thread_size
-            && m_cur_thread_size < m_thread_size_thresh_hold)
-        {
-            std::cout << "create new thread..." << std::endl;
-            // 创建新线程
-            auto ptr = std::make_unique<Thread>(std::bind(&ThreadPool::thread_func, this, std::placeholders::_1));
-            int threadId = ptr->get_id();
-            m_threads.emplace(threadId, std::move(ptr));
-            m_threads[threadId]->start();
-            m_cur_thread_size++;
-            m_idle_thread_size++;
+            && m_cur_thread_size < thread_limit)
+        {
+            THREADPOOL_LOG("create new thread...");
+            // 创建新线程，失败时任务已经在队列中，由现有线程执行，不向调用方抛出
+            try
+            {
+                create_thread();
+            }
+            catch (const std::system_error& e)
+            {
+                std::cerr << "create thread fail: " << e.what() << std::endl;
+            }
         }
         //cached 任务处理比较紧急，场景：小而快的任务 需要根据任务数量和空闲线程的数量，判断是否需要
         return result;        
@@ -150,23 +256,89 @@ public:
         m_is_pool_running = true;
         m_init_thread_size = init_thread_size;
 
-        // 创建线程对象
-        for (int i = 0; i < m_init_thread_size; ++i)
+        // 创建并启动线程
+        std::unique_lock<std::mutex> lock(m_task_que_mtx);
+        // 延迟启动时只为start之前已经提交的任务创建线程，其余由submitTask按需创建
+        size_t thread_size = m_is_lazy_start
+            ? std::min<size_t>(m_task_size, m_init_thread_size)
+            : m_init_thread_size;
+        for (size_t i = 0; i < thread_size; ++i)
+        {
+            create_thread();
+        }
+        if (m_is_lazy_start)
+        {
+            return;
+        }
+        // 需要预热时，等所有线程完成预热后再返回，第一个任务不用再等线程启动
+        if (m_is_warm_up)
         {
-            auto ptr = std::make_unique<Thread>(std::bind(&ThreadPool::thread_func, this, std::placeholders::_1));
-            int threadId = ptr->get_id();
-            m_threads.emplace(threadId, std::move(ptr));
+            m_ready_cond.wait(lock, [&]()->bool { return m_ready_thread_size >= m_init_thread_size; });
         }
+    }
 
-        // 启动所有线程
-        for (int i = 0; i < m_init_thread_size; ++i)
+    // 设置工作线程的栈大小，单位：字节，0表示使用系统默认值
+    void set_stack_size(size_t stack_size)
+    {
+        if (check_running_state())
         {
-            m_threads[i]->start(); // 需要去执行一个线程函数bug
-            m_idle_thread_size++;
-            m_cur_thread_size++;
+            return;
         }
+        m_stack_size = stack_size;
     }
-    // 设置task任务队列上线阈值
+
+    // 设置工作线程名的前缀，线程名为 前缀 + 线程id
+    void set_thread_name(const std::string& prefix)
+    {
+        if (check_running_state())
+        {
+            return;
+        }
+        m_thread_name = prefix;
+    }
+
+    // 设置延迟启动，start时不创建线程，提交任务时按需创建，直到初始线程数量
+    void set_lazy_start(bool is_lazy)
+    {
+        if (check_running_state())
+        {
+            return;
+        }
+        m_is_lazy_start = is_lazy;
+    }
+
+    // 设置预热，线程启动时预先写入栈与临时内存，避免第一个任务触发缺页
+    void set_warm_up(bool is_warm_up)
+    {
+        if (check_running_state())
+        {
+            return;
+        }
+        m_is_warm_up = is_warm_up;
+    }
+
+    // 当前线程在本线程池中的下标，范围[0, worker_capacity())，不是本线程池的工作线程时返回-1
+    int current_worker_index() const
+    {
+        return t_current_pool == this ? t_worker_index : -1;
+    }
+
+    // 工作线程下标的上限，cached模式下为线程数量上限阈值
+    size_t worker_capacity() const
+    {
+        if (m_pool_mode == PoolMode::MODE_CACHED)
+        {
+            return std::max(m_init_thread_size, m_thread_size_thresh_hold);
+        }
+        return m_init_thread_size;
+    }
+
+    // 当前工作线程的临时内存，每个任务执行完后reset，不是本线程池的工作线程时返回nullptr
+    BumpArena* worker_arena() const
+    {
+        return t_current_pool == this ? t_worker_arena : nullptr;
+    }
+    // 设置task任务队列上线阈值，未单独配置的租户子队列使用该阈值
     void set_task_que_max_thresh_hold(size_t threshhold)
     {
         if (check_running_state())
@@ -176,6 +348,43 @@ public:
         m_task_que_max_thresh_hold = threshhold;
     }
 
+    // 设置cached模式下线程的空闲回收时间，单位：秒
+    void set_thread_max_idle_time(int seconds)
+    {
+        if (check_running_state())
+        {
+            return;
+        }
+        m_thread_max_idle_time = seconds;
+    }
+
+    // 当前线程总数
+    size_t thread_size() const
+    {
+        return m_cur_thread_size;
+    }
+
+    // 开始录制任务负载：记录每个任务的提交时间、类别标签与执行耗时，写入path
+    bool start_capture(const std::string& path)
+    {
+        std::unique_lock<std::mutex> lock(m_capture_mtx);
+        if (!m_capture_writer.open(path))
+        {
+            return false;
+        }
+        m_capture_begin = std::chrono::steady_clock::now();
+        m_is_capturing.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // 停止录制并把缓冲的记录写入文件
+    void stop_capture()
+    {
+        m_is_capturing.store(false);
+        std::unique_lock<std::mutex> lock(m_capture_mtx);
+        m_capture_writer.close();
+    }
+
     // 设置线程池cached模式下线程阈值
     void set_thread_size_thresh_hold(size_t threshhold)
     {
@@ -188,29 +397,273 @@ public:
             m_thread_size_thresh_hold = threshhold;
         }        
     }
+
+    // 配置租户的调度权重与子队列上限，每轮的执行时间配额为 weight * TENANT_QUANTUM_NS
+    void set_tenant(int tenant_id, int weight, size_t max_thresh_hold)
+    {
+        std::unique_lock<std::mutex> lock(m_task_que_mtx);
+        TenantQueue& tenant = get_tenant(tenant_id);
+        tenant.m_weight = weight > 0 ? weight : 1;
+        tenant.m_max_thresh_hold = max_thresh_hold;
+        m_not_full.notify_all();
+    }
+
+    // 获取租户的统计信息
+    TenantStats get_tenant_stats(int tenant_id)
+    {
+        std::unique_lock<std::mutex> lock(m_task_que_mtx);
+        TenantQueue& tenant = get_tenant(tenant_id);
+        return TenantStats{
+            tenant.m_task_que.size(),
+            tenant.m_running.load(),
+            std::chrono::nanoseconds(tenant.m_cpu_time_ns.load())};
+    }
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool operator=(const ThreadPool&) = delete;
 
 private:
+    using Task = std::function<void()>;
+
+    // 队列中的任务
+    struct QueuedTask
+    {
+        Task m_task;
+    };
+
+    // 租户子队列，workers按加权差额轮转（DRR）在租户间选取任务
+    struct TenantQueue
+    {
+        std::queue<QueuedTask> m_task_que; // 租户的任务队列
+        size_t m_max_thresh_hold = TASK_MAX_THRESHHOLD; // 子队列上限阈值
+        int m_tenant_id = DEFAULT_TENANT_ID; // 租户id
+        int m_weight = 1; // 每轮的配额为 m_weight * TENANT_QUANTUM_NS
+        long long m_deficit = 0; // 本轮剩余的执行时间配额，单位：纳秒，为负表示超支
+        bool m_is_active = false; // 是否在轮转列表中
+        std::atomic_size_t m_running{0}; // 正在执行的任务数量
+        std::atomic_llong m_cpu_time_ns{0}; // 消耗的CPU时间
+        std::atomic_llong m_avg_cost_ns{0}; // 任务执行耗时的滑动平均，取任务时按它预扣配额
+        std::atomic_llong m_charge_ns{0}; // 已执行完的任务实际耗时与预扣的差额，下次轮到时计入m_deficit
+    };
+
+    // 分配池内线程id并启动线程，退出线程的id会被复用，需持有m_task_que_mtx
+    void create_thread()
+    {
+        int threadId;
+        if (!m_free_thread_ids.empty())
+        {
+            threadId = m_free_thread_ids.back();
+            m_free_thread_ids.pop_back();
+        }
+        else
+        {
+            threadId = m_next_thread_id++;
+        }
+        auto ptr = std::make_unique<Thread>([this](int id) { thread_func(id); }, threadId);
+        try
+        {
+            ptr->start(m_stack_size,
+                m_thread_name.empty() ? m_thread_name : m_thread_name + std::to_string(threadId));
+        }
+        catch (...)
+        {
+            // 线程没有创建成功，归还id，不放入m_threads，否则析构时会一直等待它退出
+            m_free_thread_ids.push_back(threadId);
+            throw;
+        }
+        // 新线程需要获取m_task_que_mtx才能访问m_threads，这里仍持有锁，启动后再放入不会被它看到空缺
+        m_threads.emplace(threadId, std::move(ptr));
+        m_cur_thread_size++;
+        m_idle_thread_size++;
+    }
+
+    // 线程退出时回收id，需持有m_task_que_mtx
+    void remove_thread(int threadid)
+    {
+        m_threads.erase(threadid);
+        m_free_thread_ids.push_back(threadid);
+        m_exit_cond.notify_all();
+    }
+
+    // 获取租户，不存在时按默认配置创建，需持有m_task_que_mtx
+    TenantQueue& get_tenant(int tenant_id)
+    {
+        auto it = m_tenants.find(tenant_id);
+        if (it == m_tenants.end())
+        {
+            it = m_tenants.emplace(std::piecewise_construct,
+                std::forward_as_tuple(tenant_id), std::forward_as_tuple()).first;
+            it->second.m_tenant_id = tenant_id;
+            it->second.m_max_thresh_hold = m_task_que_max_thresh_hold;
+        }
+        return it->second;
+    }
+
+    // 加权差额轮转，配额按执行时间计算：轮到的租户补充 weight * TENANT_QUANTUM_NS 的配额，
+    // 取任务时按该租户任务耗时的滑动平均预扣，任务执行完后再按实际耗时修正，
+    // 配额用完后让给下一个租户，超支的部分在之后的轮次中偿还，耗时长的任务因此不会占满工作线程。
+    // 空闲的租户不在轮转列表中，不会占用调度机会，需持有m_task_que_mtx
+    TenantQueue* pick_task(QueuedTask& task, long long& estimate_ns)
+    {
+        while (!m_active_tenants.empty())
+        {
+            int tenant_id = m_active_tenants.front();
+            TenantQueue& tenant = m_tenants.find(tenant_id)->second;
+            tenant.m_deficit -= tenant.m_charge_ns.exchange(0);
+            if (tenant.m_task_que.empty())
+            {
+                deactivate_tenant(tenant);
+                m_active_tenants.pop_front();
+                continue;
+            }
+            if (tenant.m_deficit <= 0)
+            {
+                tenant.m_deficit += tenant.m_weight * TENANT_QUANTUM_NS;
+                if (tenant.m_deficit <= 0)
+                {
+                    // 还在偿还之前的超支，本轮跳过
+                    m_active_tenants.pop_front();
+                    m_active_tenants.push_back(tenant_id);
+                    continue;
+                }
+            }
+            task = std::move(tenant.m_task_que.front());
+            tenant.m_task_que.pop();
+            estimate_ns = tenant.m_avg_cost_ns.load();
+            tenant.m_deficit -= estimate_ns;
+            if (tenant.m_task_que.empty())
+            {
+                deactivate_tenant(tenant);
+                m_active_tenants.pop_front();
+            }
+            else if (tenant.m_deficit <= 0)
+            {
+                m_active_tenants.pop_front();
+                m_active_tenants.push_back(tenant_id);
+            }
+            return &tenant;
+        }
+        return nullptr;
+    }
+
+    // 租户队列为空时移出轮转，剩余配额作废，超支保留到下次活跃时偿还
+    static void deactivate_tenant(TenantQueue& tenant)
+    {
+        if (tenant.m_deficit > 0)
+        {
+            tenant.m_deficit = 0;
+        }
+        tenant.m_is_active = false;
+    }
+
+    // 任务执行完后按实际耗时修正预扣的配额，并更新耗时的滑动平均
+    static void charge_tenant(TenantQueue& tenant, long long estimate_ns, long long cost_ns)
+    {
+        tenant.m_charge_ns += cost_ns - estimate_ns;
+        long long avg = tenant.m_avg_cost_ns.load();
+        tenant.m_avg_cost_ns.store(avg + (cost_ns - avg) / 8);
+    }
+
+    // 预先写入一段栈空间，让这些页在执行任务前就已经映射
+    static void warm_up_stack(size_t size)
+    {
+        volatile char* stack = static_cast<volatile char*>(alloca(size));
+        for (size_t i = 0; i < size; i += 4096)
+        {
+            stack[i] = 0;
+        }
+    }
+
+    // 录制开始后的纳秒数，未录制时返回-1
+    long long capture_now_ns() const
+    {
+        if (!m_is_capturing.load(std::memory_order_acquire))
+        {
+            return -1;
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_capture_begin).count();
+    }
+
+    // 写入一条录制记录
+    void capture(long long submit_ns, uint32_t tag, int tenant_id, long long run_ns)
+    {
+        std::unique_lock<std::mutex> lock(m_capture_mtx);
+        if (m_is_capturing.load())
+        {
+            m_capture_writer.append(CaptureRecord{
+                static_cast<uint64_t>(submit_ns), static_cast<uint64_t>(run_ns), tag, tenant_id});
+        }
+    }
+
+    // 录制中提交的任务在执行期间持有，析构时写入该任务的执行耗时
+    class CaptureScope
+    {
+    public:
+        CaptureScope(ThreadPool& pool, long long submit_ns, uint32_t tag, int tenant_id)
+            : m_pool(pool)
+            , m_submit_ns(submit_ns)
+            , m_tag(tag)
+            , m_tenant_id(tenant_id)
+            , m_begin(std::chrono::steady_clock::now())
+        {}
+        ~CaptureScope()
+        {
+            long long run_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_begin).count();
+            m_pool.capture(m_submit_ns, m_tag, m_tenant_id, run_ns);
+        }
+        CaptureScope(const CaptureScope&) = delete;
+        CaptureScope& operator=(const CaptureScope&) = delete;
+    private:
+        ThreadPool& m_pool;
+        long long m_submit_ns;
+        uint32_t m_tag;
+        int m_tenant_id;
+        std::chrono::steady_clock::time_point m_begin;
+    };
+
+    // 当前线程消耗的CPU时间
+    static long long thread_cpu_time_ns()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
     // 定义线程函数
     void thread_func(int threadid)
     {
+        BumpArena arena; // 第一次分配时才申请内存
+        t_current_pool = this;
+        t_worker_index = threadid;
+        t_worker_arena = &arena;
+        if (m_is_warm_up)
+        {
+            size_t size = m_stack_size > 0 ? std::min(STACK_WARM_UP_SIZE, m_stack_size / 2) : STACK_WARM_UP_SIZE;
+            warm_up_stack(size);
+            arena.warm_up();
+            std::unique_lock<std::mutex> lock(m_task_que_mtx);
+            m_ready_thread_size++;
+            m_ready_cond.notify_all();
+        }
         auto last_time = std::chrono::high_resolution_clock().now();
         while (m_is_pool_running)
         {
-            Task task;
+            QueuedTask task;
+            long long estimate_ns = 0;
+            TenantQueue* tenant = nullptr;
             {
                 std::unique_lock<std::mutex> lock(m_task_que_mtx);
 
-                std::cout << "tid:" << std::this_thread::get_id()
-                    << "尝试获取任务..." << std::endl;
+                THREADPOOL_LOG("tid:" << std::this_thread::get_id()
+                    << "尝试获取任务...");
 
                 // cache模式下，超过数量的线程需要进行回收
                 
 
                 // 每一秒中返回一次
                 // 锁 + 双重判断
-                while (m_is_pool_running && m_task_que.size() == 0)
+                while (m_is_pool_running && m_task_size == 0)
                 {
                     if (m_pool_mode == PoolMode::MODE_CACHED)
                     {
@@ -219,15 +672,17 @@ private:
                         {
                             auto now = std::chrono::high_resolution_clock().now();
                             auto dur = std::chrono::duration_cast<std::chrono::seconds>(now - last_time);
-                            if (dur.count() >= THREAD_MAX_IDLE_TIME
+                            if (dur.count() >= m_thread_max_idle_time
                                 && m_cur_thread_size > m_init_thread_size)
                             {
                                 // 开始回收当前线程
                             
                                 m_cur_thread_size--;
                                 m_idle_thread_size--;
+                                remove_thread(threadid);
+                                t_current_pool = nullptr;
 
-                                std::cout << "threadid: " << std::this_thread::get_id() << "exit!" << std::endl;
+                                THREADPOOL_LOG("threadid: " << std::this_thread::get_id() << "exit!");
                                 return;
                             }
                         }
@@ -243,31 +698,41 @@ private:
                     break;
                 }
                 m_idle_thread_size--;
-                std::cout << "tid:" << std::this_thread::get_id()
-                    << "获取任务成功..." << std::endl;
-                task = m_task_que.front();
-                m_task_que.pop();
+                THREADPOOL_LOG("tid:" << std::this_thread::get_id()
+                    << "获取任务成功...");
+                tenant = pick_task(task, estimate_ns);
+                tenant->m_running++;
                 m_task_size--;
 
-                if (m_task_que.size() > 0)
+                if (m_task_size > 0)
                 {
                     m_not_empty.notify_all();
                 }
                 m_not_full.notify_all(); 
             }
-            if (task != nullptr)
+            if (task.m_task != nullptr)
             {
-                task();
+                long long begin = thread_cpu_time_ns();
+                auto run_begin = std::chrono::steady_clock::now();
+                task.m_task();
+                long long run_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - run_begin).count();
+                tenant->m_cpu_time_ns += thread_cpu_time_ns() - begin;
+                // 按占用工作线程的时间计入租户的配额
+                charge_tenant(*tenant, estimate_ns, run_ns);
             }
+            tenant->m_running--;
+            arena.reset();
             m_idle_thread_size++;
             // 更新时间
             last_time = std::chrono::high_resolution_clock().now();
         
             
         }
-        m_threads.erase(threadid);
-        std::cout << "threadid: " << std::this_thread::get_id() << "exit!" << std::endl;    
-        m_exit_cond.notify_all();        
+        t_current_pool = nullptr;
+        THREADPOOL_LOG("threadid: " << std::this_thread::get_id() << "exit!");
+        std::unique_lock<std::mutex> lock(m_task_que_mtx);
+        remove_thread(threadid);
     }
 
     // 检查pool运行状态
@@ -279,16 +744,18 @@ private:
 private:
 
     std::unordered_map<int, std::unique_ptr<Thread>> m_threads;
+    int m_next_thread_id; // 下一个未使用过的线程id
+    std::vector<int> m_free_thread_ids; // 已退出线程的id，优先复用
 
     //std::vector<std::unique_ptr<Thread>> m_threads; // 线程列表
     size_t m_init_thread_size; // 初始线程数量
     std::atomic_int m_cur_thread_size; //当前线程池里面线程的总数量
     size_t m_thread_size_thresh_hold;// 线程数量上限阈值    
     std::atomic_int m_idle_thread_size; // 空闲线程的数量
-    using Task = std::function<void()>;
-    std::queue<Task> m_task_que; // 任务队列
+    std::unordered_map<int, TenantQueue> m_tenants; // 各租户的任务子队列
+    std::deque<int> m_active_tenants; // 有任务排队的租户，按轮转顺序排列
     std::atomic_uint m_task_size; // 任务的数量
-    size_t m_task_que_max_thresh_hold; // 任务队列的上限阈值
+    size_t m_task_que_max_thresh_hold; // 任务子队列的默认上限阈值
 
     std::mutex m_task_que_mtx; // 保证任务队列的线程安全
     std::condition_variable m_not_full; // 任务队列不满
@@ -296,7 +763,24 @@ private:
     std::condition_variable m_exit_cond; // 等待线程资源全部回收
     PoolMode m_pool_mode; //当前线程池的工作模式
 
+    int m_thread_max_idle_time; // cached模式下线程的空闲回收时间，单位：秒
+    size_t m_stack_size; // 工作线程的栈大小，0为系统默认值
+    std::string m_thread_name; // 工作线程名前缀
+    bool m_is_lazy_start; // 是否延迟创建线程
+    bool m_is_warm_up; // 是否预热线程
+    size_t m_ready_thread_size; // 已完成预热的线程数量
+    std::condition_variable m_ready_cond; // 等待线程预热完成
+
     std::atomic_bool m_is_pool_running;// 表示当前线程池的启动状态
+
+    std::atomic_bool m_is_capturing{false}; // 是否正在录制任务负载
+    std::chrono::steady_clock::time_point m_capture_begin; // 录制开始时间
+    std::mutex m_capture_mtx; // 保护录制文件的写入
+    CaptureWriter m_capture_writer;
+
+    inline static thread_local const ThreadPool* t_current_pool = nullptr; // 当前线程所属的线程池
+    inline static thread_local int t_worker_index = -1; // 当前线程在线程池中的下标
+    inline static thread_local BumpArena* t_worker_arena = nullptr; // 当前线程的临时内存
     
 };
 
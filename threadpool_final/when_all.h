@@ -0,0 +1,436 @@
+#ifndef WHEN_ALL_H
+#define WHEN_ALL_H
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+when_all / when_any 组合器
+逐个 get() 收集结果时，每个结果都要一次阻塞等待和一次 notify_all。
+这里让每个子任务在完成时对共享的原子计数减一，只有最后一个（when_all）
+或第一个（when_any）完成的子任务去设置 promise，等待方只会被唤醒一次。
+*_then 版本在最后一个子任务所在的工作线程上直接执行后续任务，整个扇入阶段没有线程阻塞。
+
+example:
+ThreadPool pool;
+pool.start(4);
+auto all = when_all(pool, []{ return sum(1, 100); }, []{ return sum(101, 200); });
+auto [s1, s2] = all.get();
+auto total = when_all_then(pool, [](std::vector<uLong> v){ return v[0] + v[1]; }, jobs.begin(), jobs.end());
+*/
+
+// void 返回值统一映射为 std::monostate，便于放进 tuple/vector
+template<typename Func>
+using when_result_t = std::conditional_t<
+    std::is_void_v<std::invoke_result_t<Func&>>,
+    std::monostate,
+    std::invoke_result_t<Func&>>;
+
+namespace when_detail
+{
+    template<typename Func>
+    when_result_t<Func> invoke(Func& func)
+    {
+        if constexpr (std::is_void_v<std::invoke_result_t<Func&>>)
+        {
+            func();
+            return std::monostate{};
+        }
+        else
+        {
+            return func();
+        }
+    }
+
+    // 用func的返回值设置promise，异常同样转交给promise
+    template<typename R, typename Func>
+    void fulfill(std::promise<R>& promise, Func&& func)
+    {
+        try
+        {
+            if constexpr (std::is_void_v<R>)
+            {
+                func();
+                promise.set_value();
+            }
+            else
+            {
+                promise.set_value(func());
+            }
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    // 向线程池投递一个子任务
+    // submitTask在队列满时会返回一个已就绪的空future而不执行任务，
+    // 这种情况下子任务由当前线程直接执行，保证计数一定能走到0
+    template<typename Pool, typename Job>
+    void post(Pool& pool, Job job)
+    {
+        auto claimed = std::make_shared<std::atomic_bool>(false);
+        auto fut = pool.submitTask([claimed, job]() mutable {
+            if (!claimed->exchange(true))
+            {
+                job();
+            }
+        });
+        if (fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready
+            && !claimed->exchange(true))
+        {
+            job();
+        }
+    }
+
+    // when_all 的共享状态：结果槽 + 剩余计数 + 第一个异常
+    template<typename Values, typename Finish>
+    struct AllState
+    {
+        AllState(size_t count, Finish finish)
+            : m_remaining(count)
+            , m_failed(false)
+            , m_finish(std::move(finish))
+        {}
+
+        // 子任务完成后调用，只有最后一个到达的子任务执行收尾
+        void arrive()
+        {
+            if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                m_finish(m_error, std::move(m_values));
+            }
+        }
+
+        void fail()
+        {
+            if (!m_failed.exchange(true))
+            {
+                m_error = std::current_exception();
+            }
+        }
+
+        Values m_values;
+        std::atomic_size_t m_remaining;
+        std::atomic_bool m_failed;
+        std::exception_ptr m_error; // 只由第一个失败的子任务写入，arrive的acq_rel保证收尾时可见
+        Finish m_finish;
+    };
+
+    // when_any 的共享状态：第一个成功的结果胜出，全部失败时转交最后一个异常
+    template<typename Value, typename Finish>
+    struct AnyState
+    {
+        AnyState(size_t count, Finish finish)
+            : m_remaining(count)
+            , m_done(false)
+            , m_finish(std::move(finish))
+        {}
+
+        void win(size_t index, Value value)
+        {
+            if (!m_done.exchange(true))
+            {
+                m_finish(nullptr, index, std::move(value));
+            }
+        }
+
+        void lose()
+        {
+            if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1
+                && !m_done.exchange(true))
+            {
+                m_finish(std::current_exception(), 0, std::nullopt);
+            }
+        }
+
+        // 必须在win之后调用，保证最后一个失败者看到m_done已被置位
+        void arrive()
+        {
+            m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        std::atomic_size_t m_remaining;
+        std::atomic_bool m_done;
+        Finish m_finish;
+    };
+
+    template<typename Pool, typename Values, typename Finish, typename Tuple, size_t... I>
+    void launch_all(Pool& pool, Finish finish, Tuple&& funcs, std::index_sequence<I...>)
+    {
+        auto state = std::make_shared<AllState<Values, Finish>>(sizeof...(I), std::move(finish));
+        (post(pool, [state, func = std::move(std::get<I>(funcs))]() mutable {
+            try
+            {
+                std::get<I>(state->m_values).emplace(invoke(func));
+            }
+            catch (...)
+            {
+                state->fail();
+            }
+            state->arrive();
+        }), ...);
+    }
+
+    template<typename Values, size_t... I>
+    auto unwrap(Values&& values, std::index_sequence<I...>)
+    {
+        return std::make_tuple(std::move(*std::get<I>(values))...);
+    }
+
+    template<typename Pool, typename Finish, typename Iter>
+    void launch_all_range(Pool& pool, Finish finish, Iter first, Iter last)
+    {
+        using Value = when_result_t<typename std::iterator_traits<Iter>::value_type>;
+        using Values = std::vector<std::optional<Value>>;
+        size_t count = std::distance(first, last);
+        if (count == 0)
+        {
+            finish(nullptr, Values());
+            return;
+        }
+        auto state = std::make_shared<AllState<Values, Finish>>(count, std::move(finish));
+        state->m_values.resize(count);
+        for (size_t i = 0; first != last; ++first, ++i)
+        {
+            post(pool, [state, i, func = *first]() mutable {
+                try
+                {
+                    state->m_values[i].emplace(invoke(func));
+                }
+                catch (...)
+                {
+                    state->fail();
+                }
+                state->arrive();
+            });
+        }
+    }
+
+    template<typename Value>
+    std::vector<Value> unwrap(std::vector<std::optional<Value>>&& values)
+    {
+        std::vector<Value> out;
+        out.reserve(values.size());
+        for (auto& v : values)
+        {
+            out.push_back(std::move(*v));
+        }
+        return out;
+    }
+
+    template<typename Pool, typename Value, typename Finish, typename Tuple, size_t... I>
+    void launch_any(Pool& pool, Finish finish, Tuple&& funcs, std::index_sequence<I...>)
+    {
+        auto state = std::make_shared<AnyState<Value, Finish>>(sizeof...(I), std::move(finish));
+        (post(pool, [state, func = std::move(std::get<I>(funcs))]() mutable {
+            try
+            {
+                Value value(std::in_place_index<I>, invoke(func));
+                state->win(I, std::move(value));
+                state->arrive();
+            }
+            catch (...)
+            {
+                state->lose();
+            }
+        }), ...);
+    }
+
+    template<typename Pool, typename Finish, typename Iter>
+    void launch_any_range(Pool& pool, Finish finish, Iter first, Iter last)
+    {
+        using Value = when_result_t<typename std::iterator_traits<Iter>::value_type>;
+        size_t count = std::distance(first, last);
+        if (count == 0)
+        {
+            finish(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)), 0, std::nullopt);
+            return;
+        }
+        auto state = std::make_shared<AnyState<Value, Finish>>(count, std::move(finish));
+        for (size_t i = 0; first != last; ++first, ++i)
+        {
+            post(pool, [state, i, func = *first]() mutable {
+                try
+                {
+                    Value value = invoke(func);
+                    state->win(i, std::move(value));
+                    state->arrive();
+                }
+                catch (...)
+                {
+                    state->lose();
+                }
+            });
+        }
+    }
+}
+
+// 等待全部任务完成，结果按提交顺序放在tuple中；任一任务抛出异常时，future中保存第一个异常
+template<typename Pool, typename... Funcs>
+auto when_all(Pool& pool, Funcs&&... funcs)
+    -> std::future<std::tuple<when_result_t<std::decay_t<Funcs>>...>>
+{
+    using Result = std::tuple<when_result_t<std::decay_t<Funcs>>...>;
+    using Values = std::tuple<std::optional<when_result_t<std::decay_t<Funcs>>>...>;
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto result = promise->get_future();
+    auto finish = [promise](std::exception_ptr error, Values&& values) {
+        if (error)
+        {
+            promise->set_exception(error);
+            return;
+        }
+        promise->set_value(when_detail::unwrap(std::move(values), std::index_sequence_for<Funcs...>()));
+    };
+    when_detail::launch_all<Pool, Values>(pool, std::move(finish),
+        std::make_tuple(std::forward<Funcs>(funcs)...), std::index_sequence_for<Funcs...>());
+    return result;
+}
+
+// 范围版本：[first, last) 中为可调用对象，结果按顺序放在vector中
+template<typename Pool, typename Iter>
+auto when_all(Pool& pool, Iter first, Iter last)
+    -> std::future<std::vector<when_result_t<typename std::iterator_traits<Iter>::value_type>>>
+{
+    using Value = when_result_t<typename std::iterator_traits<Iter>::value_type>;
+    auto promise = std::make_shared<std::promise<std::vector<Value>>>();
+    auto result = promise->get_future();
+    when_detail::launch_all_range(pool,
+        [promise](std::exception_ptr error, std::vector<std::optional<Value>>&& values) {
+            if (error)
+            {
+                promise->set_exception(error);
+                return;
+            }
+            promise->set_value(when_detail::unwrap(std::move(values)));
+        }, first, last);
+    return result;
+}
+
+// 全部完成后，在最后完成的工作线程上直接执行cont(tuple)，不占用额外线程等待
+template<typename Pool, typename Cont, typename... Funcs>
+auto when_all_then(Pool& pool, Cont cont, Funcs&&... funcs)
+    -> std::future<std::invoke_result_t<Cont&, std::tuple<when_result_t<std::decay_t<Funcs>>...>>>
+{
+    using Values = std::tuple<std::optional<when_result_t<std::decay_t<Funcs>>>...>;
+    using RType = std::invoke_result_t<Cont&, std::tuple<when_result_t<std::decay_t<Funcs>>...>>;
+    auto promise = std::make_shared<std::promise<RType>>();
+    auto result = promise->get_future();
+    auto finish = [promise, cont = std::move(cont)](std::exception_ptr error, Values&& values) mutable {
+        if (error)
+        {
+            promise->set_exception(error);
+            return;
+        }
+        when_detail::fulfill(*promise, [&]() -> RType {
+            return cont(when_detail::unwrap(std::move(values), std::index_sequence_for<Funcs...>()));
+        });
+    };
+    when_detail::launch_all<Pool, Values>(pool, std::move(finish),
+        std::make_tuple(std::forward<Funcs>(funcs)...), std::index_sequence_for<Funcs...>());
+    return result;
+}
+
+// 范围版本的扇入：cont接收std::vector结果
+template<typename Pool, typename Cont, typename Iter>
+auto when_all_then(Pool& pool, Cont cont, Iter first, Iter last)
+    -> std::future<std::invoke_result_t<Cont&,
+        std::vector<when_result_t<typename std::iterator_traits<Iter>::value_type>>>>
+{
+    using Value = when_result_t<typename std::iterator_traits<Iter>::value_type>;
+    using RType = std::invoke_result_t<Cont&, std::vector<Value>>;
+    auto promise = std::make_shared<std::promise<RType>>();
+    auto result = promise->get_future();
+    when_detail::launch_all_range(pool,
+        [promise, cont = std::move(cont)](std::exception_ptr error, std::vector<std::optional<Value>>&& values) mutable {
+            if (error)
+            {
+                promise->set_exception(error);
+                return;
+            }
+            when_detail::fulfill(*promise, [&]() -> RType {
+                return cont(when_detail::unwrap(std::move(values)));
+            });
+        }, first, last);
+    return result;
+}
+
+// 等待任一任务成功完成，返回<下标, 结果>；全部失败时future中保存最后一个异常
+template<typename Pool, typename... Funcs>
+auto when_any(Pool& pool, Funcs&&... funcs)
+    -> std::future<std::pair<size_t, std::variant<when_result_t<std::decay_t<Funcs>>...>>>
+{
+    using Value = std::variant<when_result_t<std::decay_t<Funcs>>...>;
+    using Result = std::pair<size_t, Value>;
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto result = promise->get_future();
+    auto finish = [promise](std::exception_ptr error, size_t index, std::optional<Value> value) {
+        if (error)
+        {
+            promise->set_exception(error);
+            return;
+        }
+        promise->set_value(Result(index, std::move(*value)));
+    };
+    when_detail::launch_any<Pool, Value>(pool, std::move(finish),
+        std::make_tuple(std::forward<Funcs>(funcs)...), std::index_sequence_for<Funcs...>());
+    return result;
+}
+
+// 范围版本：返回第一个完成的<下标, 结果>
+template<typename Pool, typename Iter>
+auto when_any(Pool& pool, Iter first, Iter last)
+    -> std::future<std::pair<size_t, when_result_t<typename std::iterator_traits<Iter>::value_type>>>
+{
+    using Value = when_result_t<typename std::iterator_traits<Iter>::value_type>;
+    using Result = std::pair<size_t, Value>;
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto result = promise->get_future();
+    when_detail::launch_any_range(pool,
+        [promise](std::exception_ptr error, size_t index, std::optional<Value> value) {
+            if (error)
+            {
+                promise->set_exception(error);
+                return;
+            }
+            promise->set_value(Result(index, std::move(*value)));
+        }, first, last);
+    return result;
+}
+
+// 第一个结果到达后，在该工作线程上直接执行cont(下标, 结果)
+template<typename Pool, typename Cont, typename Iter>
+auto when_any_then(Pool& pool, Cont cont, Iter first, Iter last)
+    -> std::future<std::invoke_result_t<Cont&, size_t,
+        when_result_t<typename std::iterator_traits<Iter>::value_type>>>
+{
+    using Value = when_result_t<typename std::iterator_traits<Iter>::value_type>;
+    using RType = std::invoke_result_t<Cont&, size_t, Value>;
+    auto promise = std::make_shared<std::promise<RType>>();
+    auto result = promise->get_future();
+    when_detail::launch_any_range(pool,
+        [promise, cont = std::move(cont)](std::exception_ptr error, size_t index, std::optional<Value> value) mutable {
+            if (error)
+            {
+                promise->set_exception(error);
+                return;
+            }
+            when_detail::fulfill(*promise, [&]() -> RType {
+                return cont(index, std::move(*value));
+            });
+        }, first, last);
+    return result;
+}
+
+#endif
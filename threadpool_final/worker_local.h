@@ -0,0 +1,76 @@
+#ifndef WORKER_LOCAL_H
+#define WORKER_LOCAL_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "threadpool.h"
+
+/*
+线程池内每个工作线程各自一份的数据，第一次在某个工作线程上访问时才构造。
+任务可以把可复用的缓冲、缓存放在这里，不必每次重新构造，也不必对共享缓存加锁。
+同一下标上的线程退出后，新线程会复用该下标，也会继续使用原来那份数据。
+
+example:
+ThreadPool pool;
+pool.start(4);
+WorkerLocal<std::vector<char>> buffers(pool);
+pool.submitTask([&]() {
+    std::vector<char>& buf = buffers.local();
+    buf.clear();
+    ...
+});
+*/
+template<typename T>
+class WorkerLocal
+{
+public:
+    using Factory = std::function<std::unique_ptr<T>()>;
+
+    explicit WorkerLocal(ThreadPool& pool, Factory factory = []() { return std::make_unique<T>(); })
+        : m_pool(pool)
+        , m_factory(std::move(factory))
+    {}
+    WorkerLocal(const WorkerLocal&) = delete;
+    WorkerLocal& operator=(const WorkerLocal&) = delete;
+
+    // 当前工作线程的数据，只能在该线程池的工作线程中调用
+    T& local()
+    {
+        int index = m_pool.current_worker_index();
+        if (index < 0)
+        {
+            throw std::logic_error("WorkerLocal::local() called outside of its pool's workers");
+        }
+        // 第一次访问时线程池已经启动，此时才能确定下标的上限
+        std::call_once(m_init_flag, [this]() { m_slots.resize(m_pool.worker_capacity()); });
+        std::unique_ptr<T>& slot = m_slots[index];
+        if (slot == nullptr)
+        {
+            slot = m_factory();
+        }
+        return *slot;
+    }
+
+    // 遍历已经构造的数据，用于汇总结果，调用时不能有任务正在访问
+    template<typename Func>
+    void for_each(Func func)
+    {
+        for (auto& slot : m_slots)
+        {
+            if (slot != nullptr)
+            {
+                func(*slot);
+            }
+        }
+    }
+private:
+    ThreadPool& m_pool;
+    Factory m_factory;
+    std::once_flag m_init_flag;
+    std::vector<std::unique_ptr<T>> m_slots; // 按工作线程下标存放
+};
+
+#endif